@@ -0,0 +1,410 @@
+#include <vector>
+#include <string>
+#include <iostream>      // Pour std::cout, std::cerr
+#include <cstdlib>       // Pour std::strtol(), std::exit()
+#include <cstring>       // Pour std::memset(), std::strerror()
+#include <cstdio>        // Pour snprintf()
+#include <cerrno>        // Pour errno
+#include <ctime>         // Pour clock_gettime()
+#include <sys/socket.h>  // Pour socket(), connect(), send(), recv()
+#include <sys/wait.h>    // Pour waitpid()
+#include <netinet/in.h>  // Pour struct sockaddr_in
+#include <arpa/inet.h>   // Pour inet_pton()
+#include <fcntl.h>       // Pour open()
+#include <poll.h>        // Pour poll()
+#include <unistd.h>      // Pour fork(), execv(), close(), usleep()
+#include <csignal>       // Pour kill(), signal(), SIGPIPE
+
+// Vérification d'un réseau de serveurs sur le loopback : lance trois ircserv liés en chaîne
+// (a - b - c), y connecte des clients et contrôle le PRIVMSG entre serveurs, le nettoyage
+// après QUIT et SQUIT, puis la résolution d'une collision de pseudos au retour d'un serveur
+// Chaque contrôle affiche "ok" ou "FAIL" ; le code de sortie vaut 2 si l'un d'eux échoue
+
+// Options de la ligne de commande
+struct CheckConfig {
+    std::string server;         // Exécutable du serveur
+    int port;                   // Port client du premier serveur (les suivants : +1, +2)
+    std::string password;
+    std::string linkPassword;
+
+    CheckConfig() : server("./ircserv"), port(16670), password("checkpass"), linkPassword("linkpass") {}
+};
+
+// Serveur du réseau lancé par l'outil
+struct Node {
+    std::string name;           // --server-name
+    int port;                   // Port client
+    int metricsPort;            // Export des métriques (état des liens)
+    int uplink;                 // Port du serveur auquel il se lie (0 = aucun)
+    pid_t pid;                  // Processus (-1 = arrêté)
+
+    Node() : port(0), metricsPort(0), uplink(0), pid(-1) {}
+};
+
+// Client IRC de test (socket bloquant, lecture bornée par poll)
+struct Client {
+    int fd;
+    std::string nickname;
+    std::string input;          // Octets reçus pas encore découpés en lignes
+
+    Client() : fd(-1) {}
+};
+
+// Délai d'attente par défaut d'une ligne ou d'un état du réseau (ms)
+static const long WAIT_MS = 3000;
+
+// Horloge monotone en millisecondes
+static long nowMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --server=PATH          Server executable (default: ./ircserv)" << std::endl;
+    std::cerr << "  --port=PORT            First client port; uses PORT..PORT+2 and PORT+10..PORT+12 "
+                 "(default: 16670)" << std::endl;
+    std::cerr << "  --password=PASS        Connection password (default: checkpass)" << std::endl;
+    std::cerr << "  --link-password=PASS   Link password (default: linkpass)" << std::endl;
+}
+
+// Analyse les options --nom=valeur
+static bool parseOptions(int argc, char** argv, CheckConfig& config)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        size_t equal = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || equal == std::string::npos)
+            return false;
+
+        std::string name = arg.substr(2, equal - 2);
+        std::string value = arg.substr(equal + 1);
+        char* end;
+        long number = std::strtol(value.c_str(), &end, 10);
+
+        if (name == "server" && !value.empty())
+            config.server = value;
+        else if (name == "port" && !value.empty() && *end == '\0' && number > 0 && number <= 65523)
+            config.port = (int)number;
+        else if (name == "password" && !value.empty())
+            config.password = value;
+        else if (name == "link-password" && !value.empty())
+            config.linkPassword = value;
+        else
+            return false;
+    }
+    return true;
+}
+
+// Ouvre une connexion TCP vers 127.0.0.1:port (-1 si refusée)
+static int connectTo(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// --- Serveurs ---
+
+// Valeur d'une métrique "ircserv_<nom> <valeur>" du serveur (-1 s'il ne répond pas)
+static long metricValue(const Node& node, const std::string& name)
+{
+    int fd = connectTo(node.metricsPort);
+    if (fd < 0)
+        return -1;
+
+    std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+    std::string body;
+    char buffer[4096];
+    ssize_t received;
+    while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+        body.append(buffer, received);
+    close(fd);
+
+    std::string key = "\nircserv_" + name + " ";
+    size_t pos = body.find(key);
+    if (pos == std::string::npos)
+        return -1;
+    return std::strtol(body.c_str() + pos + key.size(), NULL, 10);
+}
+
+// Attend qu'une métrique du serveur atteigne la valeur voulue
+static bool waitMetric(const Node& node, const std::string& name, long value, long timeout = WAIT_MS)
+{
+    long deadline = nowMs() + timeout;
+    for (;;)
+    {
+        if (metricValue(node, name) == value)
+            return true;
+        if (nowMs() > deadline)
+            return false;
+        usleep(50000);
+    }
+}
+
+// Lance le serveur (sortie vers /dev/null) et attend qu'il réponde sur son port de métriques
+static bool startNode(const CheckConfig& config, Node& node)
+{
+    char port[16], metrics[32], link[48];
+    snprintf(port, sizeof(port), "%d", node.port);
+    snprintf(metrics, sizeof(metrics), "--metrics-port=%d", node.metricsPort);
+    snprintf(link, sizeof(link), "--link=127.0.0.1:%d", node.uplink);
+    std::string name = "--server-name=" + node.name;
+    std::string linkPassword = "--link-password=" + config.linkPassword;
+
+    std::vector<const char*> args;
+    args.push_back(config.server.c_str());
+    args.push_back(port);
+    args.push_back(config.password.c_str());
+    args.push_back(name.c_str());
+    args.push_back(linkPassword.c_str());
+    args.push_back(metrics);
+    args.push_back("--log-level=warn");
+    args.push_back("--flood-rate=0");
+    if (node.uplink)
+        args.push_back(link);
+    args.push_back(NULL);
+
+    node.pid = fork();
+    if (node.pid < 0)
+        return false;
+    if (node.pid == 0)
+    {
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0)
+            dup2(null, STDOUT_FILENO);
+        execv(args[0], const_cast<char* const*>(&args[0]));
+        std::cerr << "Cannot run " << args[0] << ": " << std::strerror(errno) << std::endl;
+        std::exit(127);
+    }
+    return waitMetric(node, "links", node.uplink ? 1 : 0);
+}
+
+// Arrête le serveur : SIGKILL simule une panne (netsplit), SIGINT un arrêt propre
+static void stopNode(Node& node, int sig)
+{
+    if (node.pid <= 0)
+        return;
+    kill(node.pid, sig);
+    waitpid(node.pid, NULL, 0);
+    node.pid = -1;
+}
+
+// --- Clients ---
+
+static void sendLine(Client& client, const std::string& line)
+{
+    std::string data = line + "\r\n";
+    if (client.fd >= 0)
+        send(client.fd, data.data(), data.size(), 0);
+}
+
+// Lit la prochaine ligne avant l'échéance (PING servi au passage) ; false si rien n'est arrivé
+static bool readLine(Client& client, std::string& line, long deadline)
+{
+    for (;;)
+    {
+        size_t end = client.input.find('\n');
+        if (end != std::string::npos)
+        {
+            line = client.input.substr(0, end > 0 && client.input[end - 1] == '\r' ? end - 1 : end);
+            client.input.erase(0, end + 1);
+            if (line.compare(0, 5, "PING ") == 0)
+            {
+                sendLine(client, "PONG " + line.substr(5));
+                continue;
+            }
+            return true;
+        }
+
+        long remaining = deadline - nowMs();
+        if (client.fd < 0 || remaining <= 0)
+            return false;
+        struct pollfd pfd;
+        pfd.fd = client.fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, remaining) <= 0)
+            return false;
+
+        char buffer[4096];
+        ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+        {
+            close(client.fd);
+            client.fd = -1;
+            return false;
+        }
+        client.input.append(buffer, received);
+    }
+}
+
+// Attend une ligne contenant text (les autres sont ignorées)
+static bool expect(Client& client, const std::string& text, long timeout = WAIT_MS)
+{
+    long deadline = nowMs() + timeout;
+    std::string line;
+    while (readLine(client, line, deadline))
+    {
+        if (line.find(text) != std::string::npos)
+            return true;
+    }
+    return false;
+}
+
+// Vérifie qu'aucune ligne contenant text n'arrive pendant timeout ms
+static bool silent(Client& client, const std::string& text, long timeout = 300)
+{
+    return !expect(client, text, timeout);
+}
+
+// Connecte et enregistre un client ; fd = -1 si le serveur ne l'a pas accueilli (001)
+static Client connectClient(const CheckConfig& config, const Node& node, const std::string& nickname)
+{
+    Client client;
+    client.nickname = nickname;
+    client.fd = connectTo(node.port);
+    sendLine(client, "PASS " + config.password);
+    sendLine(client, "NICK " + nickname);
+    sendLine(client, "USER " + nickname + " 0 * :link check");
+    if (!expect(client, " 001 "))
+    {
+        close(client.fd);
+        client.fd = -1;
+    }
+    return client;
+}
+
+static void closeClient(Client& client)
+{
+    if (client.fd >= 0)
+        close(client.fd);
+    client.fd = -1;
+}
+
+// Affiche le résultat d'un contrôle
+static void check(const char* name, bool passed, int& failures)
+{
+    std::cout << (passed ? "ok    " : "FAIL  ") << name << std::endl;
+    if (!passed)
+        ++failures;
+}
+
+int main(int argc, char** argv)
+{
+    CheckConfig config;
+    if (!parseOptions(argc, argv, config))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    // Chaîne a - b - c : b se lie à a, c à b
+    Node nodes[3];
+    const char* names[3] = { "a.test", "b.test", "c.test" };
+    for (int i = 0; i < 3; ++i)
+    {
+        nodes[i].name = names[i];
+        nodes[i].port = config.port + i;
+        nodes[i].metricsPort = config.port + 10 + i;
+        nodes[i].uplink = i ? config.port + i - 1 : 0;
+    }
+    Node& a = nodes[0];
+    Node& b = nodes[1];
+    Node& c = nodes[2];
+    int failures = 0;
+
+    // 1. Réseau : chaque serveur connaît les deux autres
+    bool started = startNode(config, a) && startNode(config, b) && startNode(config, c);
+    check("servers linked", started && waitMetric(a, "servers", 2) && waitMetric(c, "servers", 2), failures);
+    if (!started)
+    {
+        for (int i = 0; i < 3; ++i)
+            stopNode(nodes[i], SIGINT);
+        return 1;
+    }
+
+    // 2. PRIVMSG entre serveurs, en privé et dans un channel
+    Client alice = connectClient(config, a, "alice");
+    Client bob = connectClient(config, b, "bob");
+    Client carol = connectClient(config, c, "carol");
+    check("users introduced", waitMetric(a, "remote_users", 2) && waitMetric(c, "remote_users", 2), failures);
+
+    sendLine(alice, "PRIVMSG carol :across two links");
+    check("private PRIVMSG a -> c", expect(carol, ":alice!alice@localhost PRIVMSG carol :across two links"),
+          failures);
+    sendLine(carol, "PRIVMSG alice :and back");
+    check("private PRIVMSG c -> a", expect(alice, ":carol!carol@localhost PRIVMSG alice :and back"), failures);
+
+    sendLine(carol, "JOIN #link");
+    expect(carol, " 366 ");
+    sendLine(alice, "JOIN #link");
+    check("remote JOIN seen", expect(carol, ":alice!alice@localhost JOIN #link"), failures);
+    sendLine(alice, "PRIVMSG #link :to the channel");
+    check("channel PRIVMSG a -> c", expect(carol, ":alice!alice@localhost PRIVMSG #link :to the channel"),
+          failures);
+    check("channel traffic skips non-members", silent(bob, "PRIVMSG #link"), failures);
+
+    // 3. QUIT d'un utilisateur distant : retiré de ses channels et de chaque serveur
+    sendLine(bob, "JOIN #link");
+    expect(alice, ":bob!bob@localhost JOIN #link");
+    sendLine(bob, "QUIT :leaving");
+    check("remote QUIT", expect(alice, ":bob!bob@localhost QUIT") && waitMetric(a, "remote_users", 1)
+          && waitMetric(c, "remote_users", 1), failures);
+    closeClient(bob);
+
+    // 4. SQUIT : c tombe, b l'annonce à a qui oublie c.test et ses utilisateurs
+    stopNode(c, SIGKILL);
+    closeClient(carol);
+    check("SQUIT netsplit QUIT", expect(alice, ":carol!carol@localhost QUIT :b.test c.test"), failures);
+    check("SQUIT cleanup", waitMetric(a, "servers", 1) && waitMetric(a, "remote_users", 0), failures);
+
+    // 5. Collision : pendant que b est tombé, zed s'enregistre sur a puis, plus tard, sur c ;
+    // au retour de b le plus ancien garde le pseudo et l'autre est renommé
+    started = startNode(config, c);
+    check("c relinked", started && waitMetric(a, "servers", 2), failures);
+    stopNode(b, SIGKILL);
+    check("split cleanup", waitMetric(a, "servers", 0) && waitMetric(c, "servers", 0)
+          && waitMetric(c, "remote_users", 0), failures);
+
+    Client olderZed = connectClient(config, a, "zed");
+    usleep(1100000); // Horodatages des pseudos à la seconde
+    Client newerZed = connectClient(config, c, "zed");
+    check("same nick on both sides of the split", olderZed.fd >= 0 && newerZed.fd >= 0, failures);
+
+    // c retente son lien toutes les 5 s
+    started = startNode(config, b);
+    check("network rejoined", started && waitMetric(a, "servers", 2, 10000) && waitMetric(c, "servers", 2, 10000),
+          failures);
+    check("newer nick renamed", expect(newerZed, ":zed!zed@localhost NICK :Guest"), failures);
+    check("older nick kept", silent(olderZed, " NICK "), failures);
+    sendLine(alice, "PRIVMSG zed :which one");
+    check("nick routes to the older user", expect(olderZed, "PRIVMSG zed :which one")
+          && silent(newerZed, "which one"), failures);
+
+    closeClient(alice);
+    closeClient(olderZed);
+    closeClient(newerZed);
+    for (int i = 0; i < 3; ++i)
+        stopNode(nodes[i], SIGINT);
+
+    std::cout << (failures ? "FAILED" : "OK") << " (" << failures << " failed check(s))" << std::endl;
+    return failures ? 2 : 0;
+}
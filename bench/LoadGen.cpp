@@ -0,0 +1,397 @@
+#include <vector>
+#include <string>
+#include <algorithm>     // Pour std::sort()
+#include <iostream>      // Pour std::cout, std::cerr
+#include <cstdlib>       // Pour std::strtod(), strtoull()
+#include <cstring>       // Pour std::strerror()
+#include <cstdio>        // Pour snprintf()
+#include <cerrno>        // Pour errno
+#include <ctime>         // Pour clock_gettime()
+#include <stdint.h>      // Pour uint64_t
+#include <sys/socket.h>  // Pour socket(), connect(), send(), recv()
+#include <netinet/in.h>  // Pour struct sockaddr_in
+#include <netinet/tcp.h> // Pour TCP_NODELAY
+#include <arpa/inet.h>   // Pour inet_pton()
+#include <fcntl.h>       // Pour fcntl()
+#include <poll.h>        // Pour poll()
+#include <unistd.h>      // Pour close()
+#include <csignal>       // Pour signal(), SIGPIPE
+
+// Générateur de charge : N connexions locales s'enregistrent, rejoignent M channels,
+// envoient des PRIVMSG horodatés à un débit donné et mesurent la latence de diffusion
+// (horodatage de l'envoi inclus dans le message, comparé à l'heure de réception)
+
+// Options de la ligne de commande
+struct LoadConfig {
+    std::string host;
+    int port;
+    std::string password;
+    size_t clients;         // Connexions ouvertes
+    size_t channels;        // Channels rejoints par chaque connexion
+    double rate;            // PRIVMSG envoyés par seconde (toutes connexions)
+    double duration;        // Durée de la phase d'envoi (secondes)
+    size_t payload;         // Taille du texte de chaque message (octets, au moins l'horodatage)
+
+    LoadConfig() : host("127.0.0.1"), port(6667), password("password"), clients(50), channels(5),
+                   rate(5000), duration(5), payload(64) {}
+};
+
+// Connexion simulée
+struct Connection {
+    int fd;
+    std::string nickname;
+    std::string input;      // Octets reçus pas encore découpés en lignes
+    std::string output;     // Octets pas encore acceptés par le socket
+    size_t joined;          // Fins de NAMES (366) reçues
+    bool registered;        // 001 reçu
+
+    Connection() : fd(-1), joined(0), registered(false) {}
+};
+
+// Résultats de la mesure
+struct LoadStats {
+    unsigned long sent;             // PRIVMSG envoyés
+    unsigned long delivered;        // PRIVMSG horodatés reçus
+    std::vector<uint64_t> latencies;// Latences de diffusion (ns)
+
+    LoadStats() : sent(0), delivered(0) {}
+};
+
+// Horloge monotone en nanosecondes
+static uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --host=ADDR        Server address (default: 127.0.0.1)" << std::endl;
+    std::cerr << "  --port=PORT        Server port (default: 6667)" << std::endl;
+    std::cerr << "  --password=PASS    Connection password (default: password)" << std::endl;
+    std::cerr << "  --clients=N        Connections (default: 50)" << std::endl;
+    std::cerr << "  --channels=M       Channels joined by every connection (default: 5)" << std::endl;
+    std::cerr << "  --rate=R           PRIVMSG per second, all connections (default: 5000)" << std::endl;
+    std::cerr << "  --duration=S       Sending phase in seconds (default: 5)" << std::endl;
+    std::cerr << "  --payload=B        Message text size in bytes (default: 64)" << std::endl;
+}
+
+// Analyse les options --nom=valeur
+static bool parseOptions(int argc, char** argv, LoadConfig& config)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        size_t equal = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || equal == std::string::npos)
+            return false;
+
+        std::string name = arg.substr(2, equal - 2);
+        std::string value = arg.substr(equal + 1);
+        char* end;
+        double number = std::strtod(value.c_str(), &end);
+        bool numeric = !value.empty() && *end == '\0' && number > 0;
+
+        if (name == "host")
+            config.host = value;
+        else if (name == "password")
+            config.password = value;
+        else if (name == "port" && numeric && number <= 65535)
+            config.port = (int)number;
+        else if (name == "clients" && numeric)
+            config.clients = (size_t)number;
+        else if (name == "channels" && numeric)
+            config.channels = (size_t)number;
+        else if (name == "rate" && numeric)
+            config.rate = number;
+        else if (name == "duration" && numeric)
+            config.duration = number;
+        else if (name == "payload" && numeric)
+            config.payload = (size_t)number;
+        else
+            return false;
+    }
+    return config.clients >= 2;
+}
+
+// Ouvre une connexion non bloquante (connect bloquant en local, puis O_NONBLOCK)
+static int connectTo(const LoadConfig& config)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    if (inet_pton(AF_INET, config.host.c_str(), &addr.sin_addr) != 1
+        || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+// Envoie ce que le socket accepte ; le reste attend le prochain POLLOUT
+static bool flushConnection(Connection& conn)
+{
+    while (!conn.output.empty())
+    {
+        ssize_t sent = send(conn.fd, conn.output.data(), conn.output.size(), 0);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conn.output.erase(0, sent);
+    }
+    return true;
+}
+
+static bool queueLine(Connection& conn, const std::string& line)
+{
+    conn.output += line;
+    conn.output += "\r\n";
+    return flushConnection(conn);
+}
+
+static std::string channelName(size_t index)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "#bench%lu", (unsigned long)index);
+    return name;
+}
+
+// Traite une ligne reçue : enregistrement, fin de NAMES, PING, PRIVMSG horodaté
+static void handleLine(Connection& conn, const std::string& line, uint64_t now, LoadStats& stats)
+{
+    if (line.compare(0, 5, "PING ") == 0)
+    {
+        queueLine(conn, "PONG " + line.substr(5));
+        return;
+    }
+
+    size_t space = line.find(' ');
+    if (space == std::string::npos)
+        return;
+    std::string rest = line.substr(space + 1);
+
+    if (rest.compare(0, 4, "001 ") == 0)
+        conn.registered = true;
+    else if (rest.compare(0, 4, "366 ") == 0)
+        ++conn.joined;
+    else if (rest.compare(0, 8, "PRIVMSG ") == 0)
+    {
+        // Texte : "<horodatage ns> <remplissage>"
+        size_t text = rest.find(" :");
+        if (text == std::string::npos)
+            return;
+        uint64_t sentAt = strtoull(rest.c_str() + text + 2, NULL, 10);
+        if (sentAt == 0 || sentAt > now)
+            return;
+        ++stats.delivered;
+        stats.latencies.push_back(now - sentAt);
+    }
+}
+
+// Lit tout ce qui est disponible et traite les lignes complètes
+static bool readConnection(Connection& conn, LoadStats& stats)
+{
+    char buffer[65536];
+    for (;;)
+    {
+        ssize_t received = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (received < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return false;
+        }
+        if (received == 0)
+            return false;
+        conn.input.append(buffer, received);
+    }
+
+    uint64_t now = nowNs();
+    size_t start = 0;
+    size_t end;
+    while ((end = conn.input.find('\n', start)) != std::string::npos)
+    {
+        size_t length = end - start;
+        if (length > 0 && conn.input[end - 1] == '\r')
+            --length;
+        handleLine(conn, conn.input.substr(start, length), now, stats);
+        start = end + 1;
+    }
+    conn.input.erase(0, start);
+    return true;
+}
+
+// Attend les événements de toutes les connexions pendant au plus timeout_ms
+static bool pumpConnections(std::vector<Connection>& conns, std::vector<struct pollfd>& fds,
+                            int timeout_ms, LoadStats& stats)
+{
+    for (size_t i = 0; i < conns.size(); ++i)
+    {
+        fds[i].fd = conns[i].fd;
+        fds[i].events = POLLIN | (conns[i].output.empty() ? 0 : POLLOUT);
+        fds[i].revents = 0;
+    }
+
+    int ready = poll(&fds[0], fds.size(), timeout_ms);
+    if (ready < 0)
+        return errno == EINTR;
+
+    for (size_t i = 0; i < conns.size() && ready > 0; ++i)
+    {
+        if (!fds[i].revents)
+            continue;
+        --ready;
+        if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) && !readConnection(conns[i], stats))
+        {
+            std::cerr << "Connection " << conns[i].nickname << " closed by server" << std::endl;
+            return false;
+        }
+        if ((fds[i].revents & POLLOUT) && !flushConnection(conns[i]))
+            return false;
+    }
+    return true;
+}
+
+// Valeur au rang p (0..1) des latences triées, en microsecondes
+static double percentileUs(const std::vector<uint64_t>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+int main(int argc, char** argv)
+{
+    LoadConfig config;
+    if (!parseOptions(argc, argv, config))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<Connection> conns(config.clients);
+    std::vector<struct pollfd> fds(config.clients);
+    LoadStats stats;
+
+    // 1. Connexion et enregistrement
+    for (size_t i = 0; i < conns.size(); ++i)
+    {
+        conns[i].fd = connectTo(config);
+        if (conns[i].fd < 0)
+        {
+            std::cerr << "Connection " << i << " failed: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        char nick[32];
+        snprintf(nick, sizeof(nick), "lg%lu", (unsigned long)i);
+        conns[i].nickname = nick;
+
+        std::string lines = "PASS " + config.password + "\r\nNICK " + nick + "\r\nUSER " + nick + " 0 * :load\r\n";
+        for (size_t c = 0; c < config.channels; ++c)
+            lines += "JOIN " + channelName(c) + "\r\n";
+        conns[i].output = lines;
+        flushConnection(conns[i]);
+    }
+
+    // 2. Attente de l'enregistrement et des JOIN (fin de NAMES pour chaque channel)
+    uint64_t deadline = nowNs() + 10000000000ULL;
+    for (;;)
+    {
+        size_t ready = 0;
+        for (size_t i = 0; i < conns.size(); ++i)
+            ready += conns[i].registered && conns[i].joined >= config.channels;
+        if (ready == conns.size())
+            break;
+        if (nowNs() > deadline)
+        {
+            std::cerr << "Timed out: " << ready << "/" << conns.size() << " connections joined" << std::endl;
+            return 1;
+        }
+        if (!pumpConnections(conns, fds, 100, stats))
+            return 1;
+    }
+
+    // 3. Envoi au débit demandé, expéditeurs et channels choisis à tour de rôle
+    std::string padding(config.payload > 20 ? config.payload - 20 : 0, 'x');
+    std::vector<std::string> channels;
+    for (size_t c = 0; c < config.channels; ++c)
+        channels.push_back(channelName(c));
+
+    uint64_t start = nowNs();
+    uint64_t stop = start + (uint64_t)(config.duration * 1e9);
+    size_t sender = 0;
+    for (uint64_t now = start; now < stop; now = nowNs())
+    {
+        unsigned long due = (unsigned long)((now - start) * config.rate / 1e9);
+        while (stats.sent < due)
+        {
+            Connection& conn = conns[sender];
+            sender = (sender + 1) % conns.size();
+
+            char stamp[32];
+            snprintf(stamp, sizeof(stamp), "%llu", (unsigned long long)nowNs());
+            conn.output += "PRIVMSG " + channels[stats.sent % channels.size()] + " :" + stamp + " " + padding + "\r\n";
+            ++stats.sent;
+        }
+        for (size_t i = 0; i < conns.size(); ++i)
+        {
+            if (!flushConnection(conns[i]))
+                return 1;
+        }
+        if (!pumpConnections(conns, fds, 1, stats))
+            return 1;
+    }
+    double elapsed = (nowNs() - start) / 1e9;
+
+    // 4. Vidange : attend les dernières diffusions (au plus 2 s sans progrès)
+    unsigned long expected = stats.sent * (conns.size() - 1);
+    uint64_t idleSince = nowNs();
+    while (stats.delivered < expected && nowNs() - idleSince < 2000000000ULL)
+    {
+        unsigned long before = stats.delivered;
+        if (!pumpConnections(conns, fds, 50, stats))
+            break;
+        if (stats.delivered != before)
+            idleSince = nowNs();
+    }
+    double total = (nowNs() - start) / 1e9;
+
+    for (size_t i = 0; i < conns.size(); ++i)
+        close(conns[i].fd);
+
+    // 5. Rapport
+    std::sort(stats.latencies.begin(), stats.latencies.end());
+    char line[256];
+    std::cout << "clients " << config.clients << ", channels " << config.channels << ", target rate "
+              << config.rate << " msg/s, payload " << config.payload << " bytes" << std::endl;
+    snprintf(line, sizeof(line), "sent       %lu msgs in %.2f s (%.0f msg/s)", stats.sent, elapsed, stats.sent / elapsed);
+    std::cout << line << std::endl;
+    snprintf(line, sizeof(line), "delivered  %lu/%lu msgs in %.2f s (%.0f msg/s)", stats.delivered, expected, total,
+             stats.delivered / total);
+    std::cout << line << std::endl;
+    snprintf(line, sizeof(line), "latency us p50 %.1f  p99 %.1f  p999 %.1f  max %.1f",
+             percentileUs(stats.latencies, 0.50), percentileUs(stats.latencies, 0.99),
+             percentileUs(stats.latencies, 0.999), percentileUs(stats.latencies, 1.0));
+    std::cout << line << std::endl;
+
+    return stats.delivered == expected ? 0 : 2;
+}
@@ -0,0 +1,332 @@
+#include "Client.hpp"
+#include "Channel.hpp"
+#include "HashMap.hpp"
+#include "IrcMessage.hpp"
+#include "CaseMap.hpp"
+#include <map>
+#include <algorithm> // Pour std::min(), std::swap()
+#include <vector>
+#include <string>
+#include <cstring>   // Pour std::strlen(), std::strncmp()
+#include <sstream>   // Pour std::ostringstream
+#include <iostream>  // Pour std::cout
+#include <iomanip>   // Pour std::setprecision()
+#include <cstdlib>   // Pour std::rand()
+#include <ctime>     // Pour clock_gettime()
+
+// Microbenchmarks des structures du serveur, sans sockets
+// Sortie TSV stable (une ligne d'en-tête puis une ligne par mesure) :
+//   benchmark <TAB> size <TAB> ops <TAB> ns_per_op
+// Un argument facultatif ne lance que les benchmarks dont le nom commence par ce préfixe
+
+// Horloge monotone en nanosecondes
+static double nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Empêche le compilateur de supprimer un résultat non utilisé
+static volatile size_t g_sink = 0;
+
+// Préfixe des benchmarks à lancer (vide = tous)
+static const char* g_filter = "";
+
+// Le benchmark (ou groupe de benchmarks) est-il sélectionné par le préfixe ?
+static bool selected(const char* name)
+{
+    size_t length = std::min(std::strlen(name), std::strlen(g_filter));
+    return std::strncmp(name, g_filter, length) == 0;
+}
+
+// Affiche une ligne de résultat
+static void report(const std::string& name, size_t size, size_t ops, double elapsed)
+{
+    std::cout << name << "\t" << size << "\t" << ops << "\t"
+              << std::fixed << std::setprecision(2) << (elapsed / ops) << std::endl;
+}
+
+// Construit le pseudo du i-ème client
+static std::string nickFor(size_t i)
+{
+    std::ostringstream oss;
+    oss << "user" << i;
+    return oss.str();
+}
+
+// Crée count clients nommés (sans socket ni boucle)
+static std::vector<Client*> makeClients(size_t count)
+{
+    std::vector<Client*> clients;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Client* client = new Client(i + 4, NULL);
+        client->setNickname(nickFor(i));
+        clients.push_back(client);
+    }
+    return clients;
+}
+
+static void deleteClients(std::vector<Client*>& clients)
+{
+    for (size_t i = 0; i < clients.size(); ++i)
+        delete clients[i];
+    clients.clear();
+}
+
+// Nombre d'opérations pour garder chaque mesure autour de quelques dizaines de ms
+static size_t opsFor(size_t size, size_t budget)
+{
+    size_t ops = budget / (size ? size : 1);
+    return ops < 10 ? 10 : ops;
+}
+
+// --- Parseur ---
+
+// Découpage d'une ligne IRC en message structuré (parseIrcMessage)
+static void benchParser()
+{
+    static const char* lines[][2] = {
+        { "parse_privmsg", "PRIVMSG #general :hello everyone, how is it going today?" },
+        { "parse_mode", "MODE #general +kl-i secret 42" },
+        { "parse_prefixed", ":nick!user@host PRIVMSG #chan :some text with: colons" },
+        { "parse_tagged", "@time=2024-01-01T00:00:00Z;msgid=abc :n!u@h PRIVMSG #c :tagged" },
+        { "parse_many_params", "USER a b c d e f g h i j k l m n :trailing parameter" },
+    };
+
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); ++i)
+    {
+        if (!selected(lines[i][0]))
+            continue;
+
+        const char* line = lines[i][1];
+        size_t length = std::strlen(line);
+        size_t ops = 2000000;
+        IrcMessage msg;
+
+        double start = nowNs();
+        for (size_t n = 0; n < ops; ++n)
+        {
+            parseIrcMessage(line, length, msg);
+            g_sink += msg.paramCount;
+        }
+        report(lines[i][0], length, ops, nowNs() - start);
+    }
+}
+
+// --- Repliement de casse ---
+
+// Repliement rfc1459 octet par octet, sans table (référence du noyau de CaseMap::fold)
+static void naiveFold(const char* in, size_t length, char* out)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        char c = in[i];
+        out[i] = (c >= 'A' && c <= '^') ? (char)(c + 0x20) : c;
+    }
+}
+
+// CaseMap::fold (SSE2 par blocs de 16 octets, table pour la fin) face à la boucle naïve
+static void benchCaseFold()
+{
+    static const size_t lengths[] = { 9, 32, 200 };
+    char input[256];
+    char output[256];
+    for (size_t i = 0; i < sizeof(input); ++i)
+        input[i] = "Nick[Away]^_Chan#Ops-{}|~42"[i % 27];
+
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+    {
+        size_t length = lengths[i];
+        size_t ops = 5000000;
+
+        if (selected("casefold_naive"))
+        {
+            double start = nowNs();
+            for (size_t n = 0; n < ops; ++n)
+            {
+                input[0] = (char)('A' + n % 26);
+                naiveFold(input, length, output);
+                g_sink += (unsigned char)output[length - 1];
+            }
+            report("casefold_naive", length, ops, nowNs() - start);
+        }
+
+        if (selected("casefold_kernel"))
+        {
+            double start = nowNs();
+            for (size_t n = 0; n < ops; ++n)
+            {
+                input[0] = (char)('A' + n % 26);
+                CaseMap::fold(input, length, output);
+                g_sink += (unsigned char)output[length - 1];
+            }
+            report("casefold_kernel", length, ops, nowNs() - start);
+        }
+    }
+}
+
+// --- Membres d'un channel ---
+
+// addMember/isMember/isOperator/removeMember et NAMES sur un channel de count membres
+static void benchMembership(size_t count)
+{
+    std::vector<Client*> clients = makeClients(count);
+    std::vector<size_t> order;
+    for (size_t i = 0; i < count; ++i)
+        order.push_back(std::rand() % count);
+
+    // Les petits channels sont remplis/vidés plusieurs fois pour stabiliser la mesure
+    size_t rounds = count >= 100000 ? 1 : 100000 / count;
+    double addElapsed = 0;
+    double removeElapsed = 0;
+
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        Channel channel("#bench");
+
+        double start = nowNs();
+        for (size_t i = 0; i < count; ++i)
+            channel.addMember(clients[i]);
+        addElapsed += nowNs() - start;
+
+        // Mesures sur le channel plein (premier tour seulement), un opérateur sur dix
+        if (round == 0)
+        {
+            for (size_t i = 0; i < count; i += 10)
+                channel.addOperator(clients[i]);
+
+            size_t ops = 1000000;
+            if (selected("channel_is_member"))
+            {
+                start = nowNs();
+                for (size_t i = 0; i < ops; ++i)
+                    g_sink += channel.isMember(clients[order[i % count]]);
+                report("channel_is_member", count, ops, nowNs() - start);
+            }
+
+            if (selected("channel_is_operator"))
+            {
+                start = nowNs();
+                for (size_t i = 0; i < ops; ++i)
+                    g_sink += channel.isOperator(clients[order[i % count]]);
+                report("channel_is_operator", count, ops, nowNs() - start);
+            }
+
+            // NAMES (RPL_NAMREPLY) tel qu'envoyé au JOIN : une ligne 353 par bloc pré-rendu
+            if (selected("channel_names"))
+            {
+                size_t namesOps = opsFor(count, 2000000);
+                start = nowNs();
+                for (size_t i = 0; i < namesOps; ++i)
+                {
+                    const std::vector<std::string>& names = channel.getNamesLines();
+                    for (size_t line = 0; line < names.size(); ++line)
+                        g_sink += (":ft_irc 353 user0 = #bench :" + names[line] + "\r\n").size();
+                }
+                report("channel_names", count, namesOps, nowNs() - start);
+            }
+        }
+
+        // Retrait de tous les membres dans un ordre aléatoire
+        std::vector<Client*> leaving(clients);
+        for (size_t i = count; i > 1; --i)
+            std::swap(leaving[i - 1], leaving[std::rand() % i]);
+        start = nowNs();
+        for (size_t i = 0; i < count; ++i)
+            channel.removeMember(leaving[i]);
+        removeElapsed += nowNs() - start;
+    }
+
+    if (selected("channel_add_member"))
+        report("channel_add_member", count, count * rounds, addElapsed);
+    if (selected("channel_remove_member"))
+        report("channel_remove_member", count, count * rounds, removeElapsed);
+
+    deleteClients(clients);
+}
+
+// --- Recherche par pseudo ---
+
+// Ancienne recherche : parcours de toute la map fd -> Client*
+static Client* linearFind(std::map<int, Client*>& clients, const std::string& nickname)
+{
+    for (std::map<int, Client*>::iterator it = clients.begin(); it != clients.end(); ++it)
+    {
+        if (it->second->getNickname() == nickname)
+            return it->second;
+    }
+    return NULL;
+}
+
+// Compare le parcours linéaire et l'index haché de findClientByNickname
+static void benchNicknameLookup(size_t count)
+{
+    std::vector<Client*> all = makeClients(count);
+    std::map<int, Client*> clients;
+    HashMap<std::string, Client*> index;
+    std::vector<std::string> queries;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        clients[all[i]->getFd()] = all[i];
+        index.set(all[i]->getNickname(), all[i]);
+    }
+    for (size_t i = 0; i < 1000; ++i)
+        queries.push_back(nickFor(std::rand() % count));
+
+    if (selected("nick_lookup_linear"))
+    {
+        // Le parcours linéaire est limité pour garder un temps d'exécution raisonnable
+        size_t linearOps = count >= 10000 ? 200 : 1000;
+        double start = nowNs();
+        for (size_t i = 0; i < linearOps; ++i)
+            g_sink += (size_t)linearFind(clients, queries[i % queries.size()]);
+        report("nick_lookup_linear", count, linearOps, nowNs() - start);
+    }
+
+    if (selected("nick_lookup_hash"))
+    {
+        size_t hashOps = 1000000;
+        double start = nowNs();
+        for (size_t i = 0; i < hashOps; ++i)
+        {
+            Client** found = index.find(queries[i % queries.size()]);
+            g_sink += (size_t)(found ? *found : NULL);
+        }
+        report("nick_lookup_hash", count, hashOps, nowNs() - start);
+    }
+
+    deleteClients(all);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+        g_filter = argv[1];
+    std::srand(42);
+
+    std::cout << "benchmark\tsize\tops\tns_per_op" << std::endl;
+
+    benchParser();
+
+    if (selected("casefold"))
+        benchCaseFold();
+
+    size_t memberSizes[] = { 10, 100, 1000, 10000, 100000 };
+    for (size_t i = 0; i < sizeof(memberSizes) / sizeof(memberSizes[0]); ++i)
+    {
+        if (selected("channel_"))
+            benchMembership(memberSizes[i]);
+    }
+
+    size_t nickSizes[] = { 100, 1000, 10000, 100000 };
+    for (size_t i = 0; i < sizeof(nickSizes) / sizeof(nickSizes[0]); ++i)
+    {
+        if (selected("nick_lookup"))
+            benchNicknameLookup(nickSizes[i]);
+    }
+
+    return (0);
+}
@@ -0,0 +1,25 @@
+#ifndef ALLOCSTATS_HPP
+#define ALLOCSTATS_HPP
+
+// Comptage des allocations du tas, actif seulement dans le build `make ALLOC_STATS=1`
+// (macro IRC_ALLOC_STATS) : operator new/delete sont alors remplacés et chaque thread
+// compte ses propres allocations, sans verrou. Dans un build normal les compteurs restent à zéro.
+
+// Compteurs cumulés d'un thread : la différence de deux lectures mesure une section de code
+struct AllocCounters {
+    unsigned long count;        // Appels à operator new / new[]
+    unsigned long bytes;        // Octets demandés
+
+    AllocCounters();
+};
+
+class AllocStats {
+public:
+    // Retourne true si le build compte les allocations
+    static bool enabled();
+
+    // Compteurs du thread appelant
+    static AllocCounters current();
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef CASEMAP_HPP
+#define CASEMAP_HPP
+
+#include <string>
+#include <cstddef>
+
+// Correspondances de casse des pseudos et des channels (annoncée par CASEMAPPING dans RPL_ISUPPORT)
+enum CaseMapping {
+    CASEMAP_RFC1459 = 0,    // A-Z -> a-z et []\^ -> {}|~ (RFC 1459 §2.2)
+    CASEMAP_ASCII           // A-Z -> a-z seulement
+};
+
+// Repliement de casse : chaque nom est replié une fois quand il est enregistré (Client, Channel),
+// les tables de pseudos et de channels sont indexées par cette forme repliée.
+// La correspondance est globale, fixée au démarrage avant toute connexion.
+class CaseMap {
+public:
+    // Nom ("rfc1459", "ascii") -> correspondance
+    static bool parse(const std::string& name, CaseMapping& mapping);
+
+    // Correspondance utilisée par fold() (rfc1459 par défaut)
+    static void set(CaseMapping mapping);
+    static CaseMapping get();
+    static const char* name();
+
+    // Replie length octets de in vers out (in et out peuvent être le même tableau)
+    static void fold(const char* in, size_t length, char* out);
+
+    // Remplace out par la forme repliée (la capacité de out est réutilisée)
+    static void fold(const char* in, size_t length, std::string& out);
+
+    // Forme repliée d'un nom
+    static std::string fold(const std::string& text);
+};
+
+#endif
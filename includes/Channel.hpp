@@ -3,23 +3,57 @@
 
 #include <string>
 #include <vector>
+#include <utility>
+#include <ctime>
+#include "HashMap.hpp"
 
 class Client; // Déclaration anticipée pour éviter les inclusions circulaires
+class MessageRef;
+
+// Statut d'un client dans le channel (bits combinables d'un MemberRecord)
+enum MemberFlag {
+    MEMBER_JOINED = 1,      // Le client est membre du channel
+    MEMBER_OPERATOR = 2,    // Le client est opérateur (@)
+    MEMBER_INVITED = 4      // Le client a une invitation en attente (mode +i)
+};
+
+// Fiche d'un client dans la table des membres
+struct MemberRecord {
+    size_t index;           // Position dans _members (si MEMBER_JOINED)
+    size_t namesLine;       // Ligne de NAMES contenant le pseudo (si MEMBER_JOINED)
+    unsigned char flags;    // Combinaison de MemberFlag
+
+    MemberRecord() : index(0), namesLine(0), flags(0) {}
+};
 
 // Représente un salon IRC avec ses membres, opérateurs et modes
 class Channel {
 private:
     std::string _name;                      // Nom du channel (ex: #general)
+    std::string _foldedName;                // Nom replié (CaseMap), clé de la table des channels
     std::string _topic;                     // Sujet du channel
     std::string _key;                       // Mot de passe du channel (mode +k)
-    std::vector<Client*> _members;          // Liste des membres du channel
-    std::vector<Client*> _operators;        // Liste des opérateurs du channel
-    std::vector<Client*> _invited;          // Liste des clients invités (mode +i)
+    std::vector<Client*> _members;          // Membres en tableau contigu (parcours des broadcasts)
+    HashMap<Client*, MemberRecord> _records;// Client -> fiche (statut + position), accès en O(1)
     bool _inviteOnly;                       // Mode +i : invitation seulement
     bool _topicRestricted;                  // Mode +t : seuls les ops changent le topic
     int _userLimit;                         // Mode +l : limite de membres (0 = pas de limite)
+    std::vector<std::pair<Client*, size_t> > _links;   // Liens serveurs menant à des membres distants, avec leur nombre
+    time_t _createdAt;                      // Horodatage du channel (SJOIN : le plus ancien garde ses modes)
+    std::vector<std::string> _namesLines;   // Réponse NAMES pré-rendue, découpée en lignes 353 (vides possibles)
+    size_t _namesBytes;                     // Octets de pseudos dans _namesLines (hors séparateurs)
+    size_t _peakMembers;                    // Plus grand nombre de membres atteint
+    unsigned long _broadcasts;              // Messages diffusés aux membres
 
 public:
+    // Longueur maximale d'une ligne IRC (sans \r\n) et place réservée à ":<serveur> 353 <pseudo> = " et " :"
+    // (serveur de 63 caractères, pseudo de Client::NICK_LENGTH au plus) : le reste accueille le nom du channel et les pseudos
+    static const size_t LINE_LENGTH = 510;
+    static const size_t NAMES_RESERVED = 104;
+
+    // Longueur maximale d'un nom de channel (CHANNELLEN dans RPL_ISUPPORT), au-delà : ERR_BADCHANMASK
+    static const size_t NAME_LENGTH = 50;
+
     // Constructeur : crée un channel avec son nom
     Channel(const std::string& name);
 
@@ -27,13 +61,25 @@ public:
     ~Channel();
 
     // Getters
-    std::string getName() const;
-    std::string getTopic() const;
-    std::string getKey() const;
+    const std::string& getName() const;
+    const std::string& getFoldedName() const;
+    const std::string& getTopic() const;
+    const std::string& getKey() const;
     bool isInviteOnly() const;
     bool isTopicRestricted() const;
     int getUserLimit() const;
-    std::vector<Client*>& getMembers();
+    const std::vector<Client*>& getMembers() const;
+    time_t getCreatedAt() const;
+
+    // Liens serveurs derrière lesquels le channel a des membres (seuls destinataires de son trafic)
+    const std::vector<std::pair<Client*, size_t> >& getLinks() const;
+
+    // Modes actifs "+itkl" et leurs paramètres (" clé limite"), pour RPL_CHANNELMODEIS et SJOIN
+    void formatModes(std::string& modes, std::string& params) const;
+
+    // Statistiques (STATS, export des métriques)
+    size_t getPeakMembers() const;
+    unsigned long getBroadcasts() const;
 
     // Setters
     void setTopic(const std::string& topic);
@@ -41,6 +87,18 @@ public:
     void setInviteOnly(bool inviteOnly);
     void setTopicRestricted(bool restricted);
     void setUserLimit(int limit);
+    void setCreatedAt(time_t createdAt);
+
+    // Statut d'un client (combinaison de MemberFlag, 0 si inconnu)
+    unsigned char getMemberFlags(Client* client) const;
+
+    // Listes des membres pour RPL_NAMREPLY (353), tenues à jour à chaque JOIN/PART/NICK/MODE o :
+    // pseudos séparés par des espaces, @ pour les opérateurs, chaque ligne tenant dans une réponse 353
+    // Les lignes vides (membres partis) sont à ignorer
+    const std::vector<std::string>& getNamesLines() const;
+
+    // Met à jour le pseudo d'un membre dans la réponse NAMES (après NICK)
+    void renameMember(Client* client, const std::string& oldNick);
 
     // Gestion des membres
     void addMember(Client* client);
@@ -57,9 +115,30 @@ public:
     bool isInvited(Client* client) const;
     void removeInvited(Client* client);
 
-    // Envoi de messages
+    // Envoi de messages (le message est sérialisé une fois puis partagé entre les membres)
+    // Seuls les membres locaux sont servis : les serveurs pairs reçoivent la commande et diffusent chez eux
     void broadcastMessage(const std::string& message, Client* sender);
+    void broadcastMessage(const MessageRef& message, Client* sender);
     void broadcastMessageAll(const std::string& message);
+    void broadcastMessageAll(const MessageRef& message);
+
+    // Envoi d'un lot multi-cibles : seuls les membres pas encore servis dans ce lot reçoivent le message
+    void broadcastMessageOnce(const MessageRef& message, Client* sender, unsigned long batch);
+
+private:
+    // Active/désactive un bit de statut (crée ou supprime la fiche au besoin)
+    void setFlag(Client* client, unsigned char flag, bool enabled);
+
+    // Compte un membre distant de plus (ou de moins) derrière son lien
+    void countLink(Client* link, bool added);
+
+    // Réponse NAMES : pseudo affiché d'un membre, ajout, retrait et remplacement dans sa ligne
+    static std::string namesToken(Client* client, unsigned char flags);
+    size_t namesBudget() const;
+    void namesAppend(MemberRecord& record, const std::string& token);
+    bool namesErase(MemberRecord& record, const std::string& token);     // true si tout a été reconstruit
+    void namesReplace(MemberRecord& record, const std::string& oldToken, const std::string& newToken);
+    void namesRebuild();
 };
 
 #endif
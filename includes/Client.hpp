@@ -2,41 +2,179 @@
 #define CLIENT_HPP
 
 #include <string>
+#include <set>
+#include <ctime>
+#include "MessageBuffer.hpp"
+#include "RingQueue.hpp"
+#include "LineBuffer.hpp"
+#include "TimerWheel.hpp"
+
+class EventLoop; // Déclaration anticipée : le client active lui-même POLLOUT sur sa boucle
+class Channel;
 
 // Représente un client connecté au serveur IRC
 class Client {
 private:
     int _fd;                    // File descriptor du socket client
     std::string _nickname;      // Pseudo du client (défini avec NICK)
+    std::string _foldedNickname;// Pseudo replié (CaseMap), clé de l'index des pseudos
     std::string _username;      // Nom d'utilisateur (défini avec USER)
-    std::string _buffer;        // Buffer pour accumuler les données reçues
+    std::string _prefix;        // Préfixe IRC ":nick!user@localhost", recalculé à chaque NICK/USER
+    LineBuffer _recvBuffer;     // Buffer de réception (lignes découpées sur place)
     bool _authenticated;        // Le client a-t-il fourni le bon mot de passe ?
     bool _registered;           // Le client a-t-il complété NICK + USER ?
+    bool _ircOperator;          // Le client s'est-il identifié avec OPER ?
+    bool _linkAuthenticated;    // PASS <mot de passe des liens> TS 6 reçu (candidat lien serveur)
+    bool _serverLink;           // Connexion établie avec un autre serveur (et non un utilisateur)
+    bool _outboundLink;         // Connexion ouverte par --link (boucle 0), en cours ou établie
+    Client* _uplink;            // Utilisateur distant : lien par lequel il est joignable (NULL = local)
+    std::string _serverName;    // Serveur de l'utilisateur, ou serveur pair pour un lien
+    unsigned long _hops;        // Sauts jusqu'à ce serveur (0 = ce serveur)
+    time_t _nickTs;             // Horodatage du pseudo (collisions entre serveurs : le plus ancien gagne)
+    RingQueue<MessageRef> _outQueue;    // File d'envoi : références vers des messages partagés
+    size_t _outOffset;          // Octets du premier message déjà envoyés
+    size_t _outBytes;           // Octets restant à envoyer dans la file
+    EventLoop* _loop;           // Boucle propriétaire (seule à toucher la file d'envoi et le socket)
+    bool _writeInterest;        // La surveillance en écriture est-elle active ?
+    bool _closing;              // Erreur d'envoi ou file trop longue : à déconnecter
+    bool _flushPending;         // Inscrit auprès de la boucle pour un envoi groupé en fin de tour
+    unsigned long _penaltyClock;// Horloge de pénalité du contrôle de flux (ms monotones, RFC 1459 §8.10)
+    bool _deferred;             // Lignes reçues en attente : inscrit auprès de la boucle pour reprise
+    bool _readPaused;           // Lecture suspendue (buffer de réception plein de lignes en attente)
+    TimerNode _timer;           // Échéance d'enregistrement, de PING ou d'inactivité (roue de la boucle)
+    unsigned long _lastActivity;// Dernière réception d'octets (ms monotones)
+    unsigned long _lastCommand; // Dernière commande autre que PING/PONG (ms monotones)
+    bool _pingPending;          // PING envoyé par le serveur, aucune donnée reçue depuis
+    unsigned long _deliveryBatch;// Dernier lot de messages multi-cibles reçu (sous le verrou d'état)
+    unsigned long _bytesQueued; // Total des octets mis en file d'attente
+    unsigned long _bytesFlushed;// Total des octets réellement envoyés
+    std::set<Channel*> _channels;       // Channels rejoints (index inverse tenu à jour par Channel)
+    std::set<Channel*> _invitations;    // Channels où une invitation est en attente
+
+    // Active la surveillance en écriture tant qu'il reste des données (ou une fermeture)
+    void updateWriteInterest();
+
+    // Recalcule le préfixe après un changement de pseudo ou de nom d'utilisateur
+    void updatePrefix();
 
 public:
-    // Constructeur : crée un nouveau client avec son file descriptor
-    Client(int fd);
+    // Taille maximale de la file d'envoi avant déconnexion (SendQ exceeded)
+    static const size_t MAX_SENDQ = 4 * 1024 * 1024;
+
+    // Longueur maximale d'un pseudo (NICKLEN dans RPL_ISUPPORT), au-delà : ERR_ERRONEUSNICKNAME
+    static const size_t NICK_LENGTH = 30;
+
+    // Constructeur : crée un nouveau client avec son file descriptor et sa boucle
+    Client(int fd, EventLoop* loop);
     ~Client();
     
     // Getters
     int getFd() const;
-    std::string getNickname() const;
-    std::string getUsername() const;
-    std::string getBuffer() const;
+    EventLoop* getLoop() const;
+    const std::string& getNickname() const;
+    const std::string& getFoldedNickname() const;
+    const std::string& getUsername() const;
+    const std::string& getPrefix() const;
+    LineBuffer& getRecvBuffer();
     bool isAuthenticated() const;
     bool isRegistered() const;
+    bool isIrcOperator() const;
+
+    // Réseau de serveurs : liens, utilisateurs distants (sans socket) et horodatage des pseudos
+    bool isLinkAuthenticated() const;
+    bool isServerLink() const;
+    bool isOutboundLink() const;
+    bool isRemote() const;
+    Client* getUplink() const;
+    const std::string& getServerName() const;
+    unsigned long getHops() const;
+    time_t getNickTs() const;
+    void setLinkAuthenticated(bool auth);
+    void setServerLink(bool link);
+    void setOutboundLink(bool outbound);
+    void setUplink(Client* uplink);
+    void setServerName(const std::string& name);
+    void setHops(unsigned long hops);
+    void setNickTs(time_t ts);
     
     // Setters
     void setNickname(const std::string& nickname);
     void setUsername(const std::string& username);
     void setAuthenticated(bool auth);
     void setRegistered(bool reg);
+    void setIrcOperator(bool oper);
     
-    // Ajoute des données reçues au buffer du client
-    void appendToBuffer(const std::string& data);
-    
-    // Vide le buffer du client
-    void clearBuffer();
+    // Met un message en file d'envoi (envoyé en fin de tour de boucle)
+    void queueMessage(const std::string& message);
+
+    // Met en file une référence vers un message partagé (broadcast sans copie)
+    // Depuis une autre boucle, le message est transmis à la boucle propriétaire ;
+    // pour un utilisateur distant, il part sur le lien qui y mène
+    void queueMessage(const MessageRef& message);
+
+    // Ajoute le message à la file d'envoi (boucle propriétaire uniquement)
+    // L'envoi a lieu une fois par tour de boucle (EventLoop::flushClients), toutes réponses regroupées
+    void deliver(const MessageRef& message);
+
+    // Envoi groupé demandé à la boucle pour ce tour
+    bool isFlushPending() const;
+    void setFlushPending(bool pending);
+
+    // Envoie autant de données que le socket l'accepte avec writev() (appelé quand il est inscriptible)
+    // Retourne false si une erreur fatale est survenue
+    bool flushOutput();
+
+    // Retourne true s'il reste des données en attente d'envoi
+    bool hasPendingOutput() const;
+
+    // Retourne true si le client doit être déconnecté (erreur d'envoi ou SendQ dépassée)
+    bool isClosing() const;
+
+    // Nombre d'octets en attente d'envoi
+    size_t getPendingBytes() const;
+
+    // Compteurs d'octets mis en file et envoyés
+    unsigned long getBytesQueued() const;
+    unsigned long getBytesFlushed() const;
+
+    // Contrôle de flux : chaque ligne avance l'horloge de cost ms (partie dans le passé ramenée à now)
+    // Une ligne n'est traitée que si l'horloge a moins de window ms d'avance (window = 0 : illimité)
+    bool canProcessLine(unsigned long now, unsigned long window) const;
+    void chargeLine(unsigned long now, unsigned long cost);
+
+    // Instant (ms monotones) où la prochaine ligne pourra être traitée
+    unsigned long nextLineTime(unsigned long window) const;
+
+    // Lignes en attente de reprise par la boucle (contrôle de flux)
+    bool isDeferred() const;
+    void setDeferred(bool deferred);
+
+    // Suspend ou reprend la surveillance en lecture du socket
+    void pauseReading(bool paused);
+    bool isReadPaused() const;
+
+    // Vivacité : minuterie du client et horodatage de son activité
+    TimerNode& getTimer();
+    unsigned long getLastActivity() const;
+    unsigned long getLastCommand() const;
+    void markActivity(unsigned long now);   // Octets reçus : annule le PING en attente
+    void markCommand(unsigned long now);    // Commande utile : remet à zéro l'inactivité
+    bool isPingPending() const;
+    void setPingPending(bool pending);
+
+    // Dédoublonnage d'un envoi multi-cibles : retourne true la première fois que le client
+    // est compté dans le lot batch, false ensuite (il a déjà reçu le message)
+    bool markDelivered(unsigned long batch);
+
+    // Index inverse des channels (appelé par Channel::addMember/removeMember)
+    const std::set<Channel*>& getChannels() const;
+    void addChannel(Channel* channel);
+    void removeChannel(Channel* channel);
+
+    // Invitations en attente (appelé par Channel::addInvited/removeInvited)
+    const std::set<Channel*>& getInvitations() const;
+    void addInvitation(Channel* channel);
+    void removeInvitation(Channel* channel);
 };
 
 #endif
\ No newline at end of file
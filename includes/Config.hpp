@@ -0,0 +1,45 @@
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "Logger.hpp"
+#include "CaseMap.hpp"
+
+// Nombre maximal de boucles d'événements (--threads)
+const long MAX_THREADS = 64;
+
+// Options de démarrage facultatives (passées après <port> <password>)
+struct ServerConfig {
+    std::string backend;        // Backend de surveillance des sockets : "poll" ou "epoll"
+    size_t threads;             // Nombre de boucles d'événements (une par thread)
+    int backlog;                // File d'attente des connexions du noyau (listen)
+    size_t acceptBudget;        // Connexions acceptées au plus par réveil d'une boucle
+    size_t floodRate;           // Lignes traitées par seconde et par client en régime continu (0 = illimité)
+    size_t floodBurst;          // Lignes traitables d'affilée avant ralentissement
+    size_t registrationTimeout; // Secondes pour compléter PASS/NICK/USER
+    size_t pingInterval;        // Secondes de silence avant un PING du serveur
+    size_t pingTimeout;         // Secondes laissées pour répondre au PING
+    size_t idleTimeout;         // Secondes sans commande (hors PING/PONG) avant déconnexion (0 = jamais)
+    LogLevel logLevel;          // Niveau minimal du journal
+    CaseMapping caseMapping;    // Comparaison des pseudos et channels sans tenir compte de la casse
+    std::string operName;       // Nom attendu par OPER <nom> <mot de passe>
+    std::string operPassword;   // Mot de passe de OPER (vide = OPER désactivé)
+    int metricsPort;            // Port local de l'export texte des métriques (0 = désactivé)
+    std::string serverName;     // Nom du serveur (réponses, préfixes, liens entre serveurs)
+    std::string linkPassword;   // Mot de passe des liens entre serveurs (vide = liens refusés)
+    std::vector<std::string> links; // Serveurs à joindre au démarrage (--link=hôte:port, répétable)
+
+    // Valeurs par défaut
+    ServerConfig();
+};
+
+// Analyse les options de la forme --nom=valeur à partir de argv[first]
+// Retourne false et remplit error si une option est inconnue ou invalide
+bool parseServerOptions(int argc, char** argv, int first, ServerConfig& config, std::string& error);
+
+// Affiche la liste des options reconnues
+void printServerOptions(const char* program);
+
+#endif
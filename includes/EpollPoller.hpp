@@ -0,0 +1,41 @@
+#ifndef EPOLLPOLLER_HPP
+#define EPOLLPOLLER_HPP
+
+#include "Poller.hpp"
+
+#ifdef __linux__
+
+#include <vector>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+// Backend basé sur epoll (Linux, level-triggered)
+// Le coût d'un wait() dépend du nombre de sockets actifs, pas du total
+class EpollPoller : public Poller {
+private:
+    int _epoll_fd;                              // Instance epoll du noyau
+    std::vector<struct epoll_event> _ready;     // Tampon rempli par epoll_wait()
+    size_t _watched;                            // Nombre de fds surveillés
+    std::vector<uint32_t> _interests;           // fd -> événements demandés (EPOLLIN/EPOLLOUT)
+
+    // Remplace les événements surveillés d'un fd déjà enregistré
+    bool modify(int fd, uint32_t interest);
+
+public:
+    EpollPoller();
+    virtual ~EpollPoller();
+
+    // Retourne true si epoll_create1() a réussi
+    bool isValid() const;
+
+    virtual bool add(int fd);
+    virtual bool setWriteInterest(int fd, bool enabled);
+    virtual bool setReadInterest(int fd, bool enabled);
+    virtual void remove(int fd);
+    virtual int wait(int timeout_ms);
+    virtual const char* name() const;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef EVENTLOOP_HPP
+#define EVENTLOOP_HPP
+
+#include <map>
+#include <vector>
+#include <string>
+#include <pthread.h>
+#include "Mutex.hpp"
+#include "MessageBuffer.hpp"
+#include "ObjectPool.hpp"
+#include "TimerWheel.hpp"
+#include "Client.hpp"
+
+class Server;
+class Poller;
+
+// Compteurs d'une boucle : modifiés par son seul thread, publiés en fin de tour pour STATS et l'export
+struct LoopStats {
+    unsigned long accepted;         // Connexions acceptées
+    unsigned long closed;           // Connexions fermées
+    unsigned long bytesIn;          // Octets reçus
+    unsigned long bytesOut;         // Octets envoyés
+    unsigned long shortWrites;      // Envois partiels (socket plein, reste en file)
+    unsigned long writes;           // Appels writev() (un par client et par tour, sauf socket plein)
+    unsigned long messagesIn;       // Lignes reçues
+    unsigned long messagesOut;      // Messages mis en file (y compris vers les autres boucles)
+    unsigned long floodDeferrals;   // Clients mis en attente par le contrôle de flux
+    unsigned long readPauses;       // Lectures suspendues (buffer de réception plein)
+    unsigned long pingsSent;        // PING envoyés par le serveur après un silence
+    unsigned long timeouts;         // Clients déconnectés par une échéance (enregistrement, PING, inactivité)
+    unsigned long allocs;           // Allocations du tas du thread (build ALLOC_STATS=1, relevé à chaque tour)
+    unsigned long allocBytes;       // Octets alloués par le thread (idem)
+
+    LoopStats();
+};
+
+// Boucle d'événements d'un thread : son socket d'écoute, son backend et ses clients
+// Les messages destinés à un client d'une autre boucle passent par la boîte aux lettres de celle-ci
+class EventLoop {
+private:
+    // Message à remettre à un client de la boucle
+    struct Delivery {
+        Client* client;
+        MessageRef message;
+    };
+
+    Server* _server;                            // Serveur propriétaire
+    size_t _id;                                 // Numéro de la boucle (0 = thread principal)
+    int _listen_fd;                             // Socket d'écoute (SO_REUSEPORT si plusieurs boucles)
+    Poller* _poller;                            // Backend de surveillance propre à la boucle
+    int _wake_pipe[2];                          // Pipe de réveil (boîte aux lettres, arrêt)
+    pthread_t _thread;                          // Thread exécutant la boucle (sauf boucle 0)
+    bool _threadStarted;                        // Le thread a-t-il été lancé ?
+    std::vector<Client*> _clients;              // Table dense indexée par fd (NULL = pas un client de la boucle)
+    size_t _clientCount;                        // Clients gérés par cette boucle
+    ObjectPool<Client> _clientPool;             // Emplacements des Client (créés et détruits par ce thread)
+    LoopStats _stats;                           // Compteurs de la boucle (thread de la boucle uniquement)
+    Mutex _statsLock;                           // Protège _published
+    LoopStats _published;                       // Copie de _stats publiée à la fin de chaque tour
+    std::vector<int> _flushQueue;               // fds des clients ayant reçu des messages pendant ce tour
+    std::vector<int> _deferred;                 // fds des clients ralentis ayant des lignes en attente
+    unsigned long _resumeAt;                    // Instant (ms monotones) de la prochaine reprise
+    unsigned long _acceptResumeAt;              // Réactivation de l'écoute suspendue (ULONG_MAX = écoute active)
+    unsigned long _acceptBackoff;               // Durée (ms) de la prochaine suspension de l'écoute
+    TimerWheel _timers;                         // Échéances des clients de la boucle (vivacité)
+
+    Mutex _mailboxLock;                         // Protège _mailbox
+    std::vector<Delivery> _mailbox;             // Messages postés par les autres boucles
+    std::vector<Delivery> _draining;            // Messages en cours de remise (réutilisé)
+    std::vector<std::vector<Delivery> > _outbox;// Messages à poster, regroupés par boucle destinataire
+    std::vector<EventLoop*> _outboxTargets;     // Boucle correspondant à chaque entrée de _outbox
+
+    EventLoop(const EventLoop&);
+    EventLoop& operator=(const EventLoop&);
+
+    // Point d'entrée des threads secondaires
+    static void* threadMain(void* arg);
+
+public:
+    EventLoop(Server* server, size_t id, size_t loopCount);
+    ~EventLoop();
+
+    // Crée le backend et le pipe de réveil ; retourne false en cas d'échec
+    bool init(const std::string& backend);
+
+    // Accesseurs
+    size_t getId() const;
+    Server* getServer() const;
+    Poller* getPoller() const;
+    int getListenFd() const;
+    void setListenFd(int fd);
+    int getWakeFd() const;
+
+    // Table des clients : création (pool), recherche en O(1) par fd, destruction
+    Client* createClient(int fd);
+    Client* findClient(int fd) const;
+    void destroyClient(Client* client);
+    size_t getClientCount() const;
+
+    // Ferme et détruit tous les clients de la boucle (arrêt du serveur)
+    void destroyAllClients();
+
+    // Compteurs : getStats() pour le thread de la boucle ; les autres lisent la copie publiée
+    LoopStats& getStats();
+    void publishStats();
+    LoopStats getPublishedStats();
+
+    // Envoi groupé : inscrit un client dont la file a reçu des messages pendant ce tour
+    void scheduleFlush(Client* client);
+
+    // Envoie la file de chaque client inscrit (un writev par client), en fin de tour, hors verrou
+    void flushClients();
+
+    // Contrôle de flux : inscrit un client dont les lignes reprendront à l'instant when
+    void defer(Client* client, unsigned long when);
+
+    // Délai (ms) avant la prochaine reprise, pour wait() (-1 si aucun client en attente)
+    int resumeTimeout(unsigned long now) const;
+
+    // Roue des minuteries des clients (armées par le serveur, désarmées à la destruction du client)
+    TimerWheel& getTimers();
+
+    // Délai (ms) passé à wait() : prochaine reprise, réactivation de l'écoute ou prochaine minuterie (-1 = aucune)
+    int nextTimeout(unsigned long now) const;
+
+    // Plus de descripteur libre (EMFILE/ENFILE) : l'écoute est suspendue, avec un délai doublé à chaque échec
+    unsigned long pauseAccept(unsigned long now);
+    void resumeAccept(unsigned long now);
+    void resetAcceptBackoff();
+
+    // Si la reprise est due, transfère les fds en attente dans fds et retourne true
+    bool takeDeferred(unsigned long now, std::vector<int>& fds);
+
+    // Boucle du thread courant (NULL hors d'une boucle)
+    static EventLoop* current();
+    static void setCurrent(EventLoop* loop);
+
+    // Lance/attend le thread de la boucle (boucles secondaires)
+    bool start();
+    void join();
+
+    // Réveille la boucle (async-signal-safe : un write() sur le pipe)
+    void wake();
+
+    // Vide le pipe de réveil après un événement lisible
+    void consumeWake();
+
+    // Prépare l'envoi d'un message à un client d'une autre boucle (appelé sous le verrou d'état)
+    void stage(Client* client, const MessageRef& message);
+
+    // Poste les messages préparés dans les boîtes aux lettres des boucles destinataires
+    // À appeler avant de relâcher le verrou d'état
+    void flushOutbox();
+
+    // Remet les messages reçus d'autres boucles dans les files d'envoi des clients
+    void drainMailbox();
+
+    // Oublie les messages en attente pour un client sur le point d'être détruit
+    void discardMailbox(Client* client);
+};
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef HASHMAP_HPP
+#define HASHMAP_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Fonctions de hachage par défaut (FNV-1a pour les chaînes, mélange pour les entiers/pointeurs)
+template <typename K>
+struct HashTraits;
+
+template <>
+struct HashTraits<std::string> {
+    static size_t hash(const std::string& key)
+    {
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < key.size(); ++i)
+        {
+            h ^= (unsigned char)key[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+};
+
+template <>
+struct HashTraits<int> {
+    static size_t hash(int key)
+    {
+        size_t h = (size_t)(unsigned int)key;
+        return h * 2654435761u;
+    }
+};
+
+template <typename T>
+struct HashTraits<T*> {
+    static size_t hash(T* key)
+    {
+        size_t h = (size_t)key;
+        h ^= h >> 4;  // Les pointeurs sont alignés : les bits de poids faible sont nuls
+        return h * 2654435761u;
+    }
+};
+
+// Table de hachage à adressage ouvert (sondage linéaire, suppression par décalage arrière)
+// Recherche, insertion et suppression en O(1) en moyenne ; itération dans l'ordre du tableau
+template <typename K, typename V, typename Traits = HashTraits<K> >
+class HashMap {
+public:
+    // Entrée de la table (first/second comme std::map pour garder la même écriture)
+    struct Entry {
+        K first;
+        V second;
+        size_t hash;
+        bool used;
+
+        Entry() : first(), second(), hash(0), used(false) {}
+    };
+
+    // Itérateur sur les entrées occupées
+    class iterator {
+    private:
+        std::vector<Entry>* _table;
+        size_t _index;
+
+        void skip()
+        {
+            while (_index < _table->size() && !(*_table)[_index].used)
+                ++_index;
+        }
+
+    public:
+        iterator(std::vector<Entry>* table, size_t index) : _table(table), _index(index) { skip(); }
+
+        Entry& operator*() const { return (*_table)[_index]; }
+        Entry* operator->() const { return &(*_table)[_index]; }
+        iterator& operator++() { ++_index; skip(); return *this; }
+        bool operator==(const iterator& other) const { return _index == other._index; }
+        bool operator!=(const iterator& other) const { return _index != other._index; }
+    };
+
+private:
+    std::vector<Entry> _table;      // Cases de la table (taille puissance de 2)
+    size_t _size;                   // Nombre d'entrées occupées
+
+    size_t mask() const { return _table.size() - 1; }
+
+    // Cherche la case d'une clé (retourne _table.size() si absente)
+    size_t locate(const K& key, size_t h) const
+    {
+        if (_table.empty())
+            return 0;
+        for (size_t i = h & mask(); ; i = (i + 1) & mask())
+        {
+            const Entry& e = _table[i];
+            if (!e.used)
+                return _table.size();
+            if (e.hash == h && e.first == key)
+                return i;
+        }
+    }
+
+    // Double la capacité quand le taux de remplissage dépasse 70%
+    void reserveFor(size_t count)
+    {
+        size_t capacity = _table.empty() ? 16 : _table.size();
+        while (count * 10 > capacity * 7)
+            capacity *= 2;
+        if (capacity == _table.size())
+            return;
+
+        std::vector<Entry> old(capacity);
+        old.swap(_table);
+        for (size_t i = 0; i < old.size(); ++i)
+        {
+            if (!old[i].used)
+                continue;
+            size_t j = old[i].hash & mask();
+            while (_table[j].used)
+                j = (j + 1) & mask();
+            _table[j] = old[i];
+        }
+    }
+
+public:
+    HashMap() : _size(0) {}
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    iterator begin() { return iterator(&_table, 0); }
+    iterator end() { return iterator(&_table, _table.size()); }
+
+    // Retourne un pointeur vers la valeur associée, NULL si absente
+    V* find(const K& key)
+    {
+        size_t i = locate(key, Traits::hash(key));
+        return i < _table.size() ? &_table[i].second : NULL;
+    }
+
+    const V* find(const K& key) const
+    {
+        size_t i = locate(key, Traits::hash(key));
+        return i < _table.size() ? &_table[i].second : NULL;
+    }
+
+    // Insère ou remplace la valeur associée à la clé
+    void set(const K& key, const V& value)
+    {
+        size_t h = Traits::hash(key);
+        size_t i = locate(key, h);
+        if (i < _table.size())
+        {
+            _table[i].second = value;
+            return;
+        }
+
+        reserveFor(_size + 1);
+        i = h & mask();
+        while (_table[i].used)
+            i = (i + 1) & mask();
+        _table[i].first = key;
+        _table[i].second = value;
+        _table[i].hash = h;
+        _table[i].used = true;
+        ++_size;
+    }
+
+    // Supprime une clé (retourne false si absente)
+    bool erase(const K& key)
+    {
+        size_t i = locate(key, Traits::hash(key));
+        if (i >= _table.size())
+            return false;
+
+        // Décalage arrière : ramène les entrées suivantes du même groupe pour ne pas laisser de trou
+        size_t j = i;
+        for (;;)
+        {
+            j = (j + 1) & mask();
+            if (!_table[j].used)
+                break;
+            size_t home = _table[j].hash & mask();
+            // L'entrée j peut occuper la case i si i est entre sa case d'origine et j (circulairement)
+            if ((j > i && (home <= i || home > j)) || (j < i && (home <= i && home > j)))
+            {
+                _table[i] = _table[j];
+                i = j;
+            }
+        }
+        _table[i] = Entry();
+        --_size;
+        return true;
+    }
+
+    // Vide la table (garde la capacité)
+    void clear()
+    {
+        for (size_t i = 0; i < _table.size(); ++i)
+            _table[i] = Entry();
+        _size = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef IRCMESSAGE_HPP
+#define IRCMESSAGE_HPP
+
+#include "StringRef.hpp"
+
+// Message IRC découpé en une seule passe (RFC 1459 + tags IRCv3)
+// [@tags] [:prefix] COMMAND [param1 ... param14] [:trailing]
+// Tous les champs sont des vues dans la ligne reçue : aucune allocation
+struct IrcMessage {
+    static const size_t MAX_PARAMS = 15;
+
+    StringRef tags;                     // Tags IRCv3 (sans le '@'), vide si absents
+    StringRef prefix;                   // Préfixe (sans le ':'), vide si absent
+    StringRef command;                  // Commande telle que reçue (casse d'origine)
+    StringRef params[MAX_PARAMS];       // Paramètres (le trailing est le dernier, sans le ':')
+    size_t paramCount;                  // Nombre de paramètres présents
+    bool hasTrailing;                   // Le dernier paramètre était-il un trailing (':...') ?
+
+    IrcMessage();
+
+    // Retourne le i-ème paramètre, ou une vue vide s'il est absent
+    const StringRef& param(size_t i) const;
+};
+
+// Découpe une ligne (sans \r\n) ; retourne false si aucune commande n'est présente
+bool parseIrcMessage(const char* line, size_t length, IrcMessage& message);
+
+// Parcourt une liste séparée par des virgules (JOIN #a,#b clé1,clé2) à partir de pos :
+// place l'élément suivant dans item (vue, éventuellement vide) et avance pos
+// Retourne false quand la liste est épuisée
+bool nextListItem(const StringRef& list, size_t& pos, StringRef& item);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef LINEBUFFER_HPP
+#define LINEBUFFER_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Buffer de réception avec curseurs de lecture/écriture
+// recv() écrit directement dedans et les lignes sont découpées sur place (aucune copie) ;
+// seuls les octets non consommés sont déplacés, et seulement quand la fin du buffer est atteinte
+class LineBuffer {
+private:
+    std::vector<char> _data;    // Zone mémoire (grandit jusqu'à MAX_CAPACITY)
+    size_t _start;              // Début des données non consommées
+    size_t _end;                // Fin des données reçues (prochaine écriture)
+    size_t _scan;               // Position jusqu'où aucun '\n' n'a été trouvé
+    bool _discarding;           // Ligne trop longue en cours d'abandon (jusqu'au prochain '\n')
+    bool _overflowed;           // Une ligne trop longue a été abandonnée depuis le dernier appel
+
+public:
+    static const size_t INITIAL_CAPACITY = 512;
+    static const size_t MAX_CAPACITY = 8192;
+
+    LineBuffer();
+
+    // Retourne la zone où recv() peut écrire et sa taille (0 si le buffer est plein)
+    // Compacte ou agrandit le buffer si nécessaire ; abandonne une ligne trop longue
+    char* writableSpace(size_t& available);
+
+    // Valide les octets écrits par recv() dans la zone retournée par writableSpace()
+    void commit(size_t count);
+
+    // Extrait la prochaine ligne complète (sans \r\n) sous forme de vue dans le buffer
+    // La vue reste valide jusqu'au prochain appel à writableSpace()
+    bool nextLine(const char*& line, size_t& length);
+
+    // Retourne true si une ligne complète attend d'être extraite (sans la consommer)
+    bool hasLine();
+
+    // Retourne true si aucune place ne peut être libérée pour recv() (lignes en attente de traitement)
+    bool full() const;
+
+    // Nombre d'octets reçus non consommés
+    size_t pending() const;
+
+    // Retourne true (une seule fois) si une ligne trop longue a été abandonnée
+    bool takeOverflow();
+};
+
+#endif
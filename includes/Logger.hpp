@@ -0,0 +1,72 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <string>
+#include <cstddef>
+
+// Niveaux de journalisation (du plus bavard au plus silencieux)
+enum LogLevel {
+    LOG_DEBUG = 0,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+    LOG_OFF
+};
+
+// Journal asynchrone : les threads déposent leurs lignes dans un anneau sans verrou,
+// un thread d'arrière-plan les écrit par lots. Si l'anneau est plein, la ligne est
+// perdue (jamais d'attente) et le nombre de lignes perdues est signalé
+class Logger {
+public:
+    // Taille maximale d'une ligne (au-delà, elle est tronquée)
+    static const size_t LINE_SIZE = 240;
+
+    // Nom de niveau ("debug", "info", "warn", "error", "off") -> niveau
+    static bool parseLevel(const std::string& name, LogLevel& level);
+
+    // Niveau minimal journalisé (modifiable à tout moment)
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+    static bool enabled(LogLevel level);
+
+    // Lance/arrête le thread d'écriture (stop() écrit les lignes restantes)
+    static bool start();
+    static void stop();
+
+    // Dépose une ligne (sans \n) ; ne bloque jamais
+    static void write(LogLevel level, const char* text, size_t length);
+
+    // Compteurs : lignes déposées et lignes perdues (anneau plein)
+    static unsigned long logged();
+    static unsigned long dropped();
+};
+
+// Ligne de journal construite avec << puis déposée à la destruction
+// Si le niveau est filtré, rien n'est formaté
+class LogLine {
+private:
+    LogLevel _level;
+    bool _enabled;
+    size_t _length;
+    char _buffer[Logger::LINE_SIZE];
+
+    LogLine(const LogLine&);
+    LogLine& operator=(const LogLine&);
+
+    LogLine& appendNumber(unsigned long value, bool negative);
+
+public:
+    explicit LogLine(LogLevel level);
+    ~LogLine();
+
+    LogLine& write(const char* text, size_t length);
+    LogLine& operator<<(const std::string& text);
+    LogLine& operator<<(const char* text);
+    LogLine& operator<<(char c);
+    LogLine& operator<<(int value);
+    LogLine& operator<<(unsigned int value);
+    LogLine& operator<<(long value);
+    LogLine& operator<<(unsigned long value);
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef MESSAGEBUFFER_HPP
+#define MESSAGEBUFFER_HPP
+
+#include <string>
+#include <cstddef>
+#include "StringRef.hpp"
+
+// Message IRC sérialisé une seule fois, immuable et partagé par compteur de références
+// Un broadcast vers N membres ne copie les octets qu'une fois : chaque file d'envoi garde une référence
+class MessageBuffer {
+private:
+    std::string _data;      // Octets du message (avec \r\n)
+    int _refs;              // Nombre de MessageRef pointant vers ce buffer (atomique : partagé entre boucles)
+    MessageBuffer* _next;   // Suivant dans la réserve du thread (buffer libre uniquement)
+
+    MessageBuffer();
+    MessageBuffer(const std::string& data);
+    ~MessageBuffer();
+
+    // Buffer vide (une référence) pris dans la réserve du thread, ou alloué si elle est vide
+    static MessageBuffer* acquire();
+
+    // Dernière référence relâchée : le buffer retourne dans la réserve du thread qui le libère
+    // (sa capacité est conservée) ou au tas si la réserve est pleine ou le buffer trop grand
+    static void recycle(MessageBuffer* buffer);
+
+    // Non copiable
+    MessageBuffer(const MessageBuffer&);
+    MessageBuffer& operator=(const MessageBuffer&);
+
+    friend class MessageRef;
+    friend class MessageBuilder;
+
+public:
+    // Rend au tas les buffers en réserve du thread appelant et de la réserve commune (fin d'une boucle)
+    static void releasePool();
+};
+
+// Référence partagée vers un MessageBuffer (libère le buffer à la dernière référence)
+class MessageRef {
+private:
+    MessageBuffer* _buffer;
+
+    void release();
+
+    // Adopte un buffer déjà rempli (MessageBuilder::finish)
+    explicit MessageRef(MessageBuffer* buffer);
+    friend class MessageBuilder;
+
+public:
+    // Référence vide
+    MessageRef();
+
+    // Sérialise le message dans un nouveau buffer partagé
+    explicit MessageRef(const std::string& data);
+
+    MessageRef(const MessageRef& other);
+    MessageRef& operator=(const MessageRef& other);
+    ~MessageRef();
+
+    // Accès aux octets du message
+    const char* data() const;
+    size_t size() const;
+    bool empty() const;
+};
+
+// Écrit un message IRC morceau par morceau directement dans un nouveau buffer partagé
+// finish() termine la ligne par \r\n et transfère le buffer à un MessageRef, sans copie ni chaîne intermédiaire
+// Le buffer vient de la réserve du thread : une fois chaude, construire un message n'alloue rien
+class MessageBuilder {
+private:
+    MessageBuffer* _buffer;     // Buffer en construction (NULL après finish)
+
+    MessageBuilder(const MessageBuilder&);
+    MessageBuilder& operator=(const MessageBuilder&);
+
+public:
+    // reserve : taille prévue du message (une seule allocation si elle suffit)
+    explicit MessageBuilder(size_t reserve = 128);
+    ~MessageBuilder();
+
+    MessageBuilder& operator<<(const std::string& text);
+    MessageBuilder& operator<<(const StringRef& text);
+    MessageBuilder& operator<<(const char* text);
+    MessageBuilder& operator<<(char c);
+    MessageBuilder& operator<<(unsigned long value);
+    MessageBuilder& append(const char* data, size_t length);
+
+    // Ajoute \r\n s'il manque et retourne le message partagé (le builder est alors vide)
+    MessageRef finish();
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef MUTEX_HPP
+#define MUTEX_HPP
+
+#include <pthread.h>
+
+// Verrou POSIX non copiable
+class Mutex {
+private:
+    pthread_mutex_t _mutex;
+
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+
+public:
+    Mutex() { pthread_mutex_init(&_mutex, NULL); }
+    ~Mutex() { pthread_mutex_destroy(&_mutex); }
+
+    void lock() { pthread_mutex_lock(&_mutex); }
+    void unlock() { pthread_mutex_unlock(&_mutex); }
+};
+
+// Prend le verrou à la construction et le relâche à la destruction (sortie de portée)
+class ScopedLock {
+private:
+    Mutex& _mutex;
+
+    ScopedLock(const ScopedLock&);
+    ScopedLock& operator=(const ScopedLock&);
+
+public:
+    explicit ScopedLock(Mutex& mutex) : _mutex(mutex) { _mutex.lock(); }
+    ~ScopedLock() { _mutex.unlock(); }
+};
+
+#endif
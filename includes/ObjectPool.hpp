@@ -0,0 +1,81 @@
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include <vector>
+#include <cstddef>
+#include <new>
+
+// Pool d'objets par blocs (slabs) : les emplacements sont alloués SlabSize par SlabSize
+// et réutilisés via une liste libre, sans repasser par le tas à chaque création/destruction
+// Non thread-safe : chaque pool appartient à un seul thread (ou est protégé par un verrou)
+template <typename T, size_t SlabSize = 64>
+class ObjectPool {
+private:
+    // Emplacement : l'objet lui-même, ou le lien vers l'emplacement libre suivant
+    // (les autres membres garantissent un alignement suffisant)
+    union Slot {
+        Slot* next;
+        char storage[sizeof(T)];
+        double alignDouble;
+        long long alignLong;
+        void* alignPointer;
+    };
+
+    std::vector<Slot*> _slabs;      // Blocs alloués (libérés à la destruction du pool)
+    Slot* _free;                    // Tête de la liste des emplacements libres
+    size_t _live;                   // Objets actuellement construits
+
+    ObjectPool(const ObjectPool&);
+    ObjectPool& operator=(const ObjectPool&);
+
+    // Ajoute un bloc et chaîne ses emplacements dans la liste libre
+    void grow()
+    {
+        Slot* slab = new Slot[SlabSize];
+        _slabs.push_back(slab);
+        for (size_t i = 0; i < SlabSize; ++i)
+        {
+            slab[i].next = _free;
+            _free = &slab[i];
+        }
+    }
+
+public:
+    ObjectPool() : _free(NULL), _live(0) {}
+
+    // Les objets doivent avoir été détruits avec destroy() avant le pool
+    ~ObjectPool()
+    {
+        for (size_t i = 0; i < _slabs.size(); ++i)
+            delete[] _slabs[i];
+    }
+
+    // Réserve un emplacement non construit : new (pool.allocate()) T(...)
+    void* allocate()
+    {
+        if (!_free)
+            grow();
+        Slot* slot = _free;
+        _free = slot->next;
+        ++_live;
+        return slot->storage;
+    }
+
+    // Détruit l'objet et rend son emplacement au pool
+    void destroy(T* object)
+    {
+        if (!object)
+            return;
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = _free;
+        _free = slot;
+        --_live;
+    }
+
+    // Objets construits / emplacements disponibles au total
+    size_t live() const { return _live; }
+    size_t capacity() const { return _slabs.size() * SlabSize; }
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef POLLPOLLER_HPP
+#define POLLPOLLER_HPP
+
+#include <vector>
+#include <poll.h>
+#include "Poller.hpp"
+
+// Backend basé sur poll() : portable, mais chaque wait() parcourt tous les sockets
+class PollPoller : public Poller {
+private:
+    std::vector<struct pollfd> _poll_fds;   // Tableau passé à poll()
+    std::vector<int> _slots;                // fd -> index dans _poll_fds (-1 = absent)
+
+public:
+    PollPoller();
+    virtual ~PollPoller();
+
+    virtual bool add(int fd);
+    virtual bool setWriteInterest(int fd, bool enabled);
+    virtual bool setReadInterest(int fd, bool enabled);
+    virtual void remove(int fd);
+    virtual int wait(int timeout_ms);
+    virtual const char* name() const;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef POLLER_HPP
+#define POLLER_HPP
+
+#include <string>
+#include <vector>
+
+// Événement de disponibilité retourné par un backend après wait()
+struct PollerEvent {
+    int fd;           // File descriptor concerné
+    bool readable;    // Données à lire (ou fermeture/erreur à récupérer via recv)
+    bool writable;    // Le socket accepte de nouvelles données en écriture
+};
+
+// Interface commune des backends de surveillance des sockets (poll, epoll)
+// La lecture est surveillée par défaut (suspendue pour un client ralenti), l'écriture seulement sur demande
+class Poller {
+protected:
+    std::vector<PollerEvent> _events;      // Événements prêts du dernier wait()
+
+public:
+    virtual ~Poller();
+
+    // Commence à surveiller un file descriptor (lecture)
+    virtual bool add(int fd) = 0;
+
+    // Active ou désactive la surveillance en écriture (POLLOUT / EPOLLOUT)
+    virtual bool setWriteInterest(int fd, bool enabled) = 0;
+
+    // Active ou désactive la surveillance en lecture (POLLIN / EPOLLIN)
+    virtual bool setReadInterest(int fd, bool enabled) = 0;
+
+    // Arrête de surveiller un file descriptor
+    virtual void remove(int fd) = 0;
+
+    // Attend des événements (timeout en ms, -1 = infini)
+    // Retourne le nombre d'événements prêts, -1 en cas d'erreur (errno positionné)
+    virtual int wait(int timeout_ms) = 0;
+
+    // Nom du backend (pour les logs)
+    virtual const char* name() const = 0;
+
+    // Événements prêts du dernier wait() (seuls les sockets actifs y figurent)
+    const std::vector<PollerEvent>& events() const;
+
+    // Crée un backend à partir de son nom ("poll" ou "epoll"), NULL si inconnu
+    static Poller* create(const std::string& backend);
+
+    // Retourne true si le backend est disponible sur cette plateforme
+    static bool isSupported(const std::string& backend);
+};
+
+#endif
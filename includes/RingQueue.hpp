@@ -0,0 +1,64 @@
+#ifndef RINGQUEUE_HPP
+#define RINGQUEUE_HPP
+
+#include <vector>
+#include <cstddef>
+
+// File FIFO sur tableau circulaire : la capacité atteinte est conservée, une fois chaude
+// la file ne repasse plus par le tas (contrairement à std::deque qui alloue et libère ses blocs)
+// Les cases libérées sont réinitialisées à T() pour relâcher aussitôt ce qu'elles tenaient
+template <typename T>
+class RingQueue {
+private:
+    std::vector<T> _slots;      // Cases (taille = capacité, puissance de 2)
+    size_t _head;               // Case du premier élément
+    size_t _count;              // Nombre d'éléments
+
+    // Double la capacité en remettant les éléments dans l'ordre à partir de la case 0
+    void grow()
+    {
+        std::vector<T> slots(_slots.empty() ? 16 : _slots.size() * 2);
+        for (size_t i = 0; i < _count; ++i)
+            slots[i] = _slots[(_head + i) & (_slots.size() - 1)];
+        _slots.swap(slots);
+        _head = 0;
+    }
+
+public:
+    RingQueue() : _head(0), _count(0) {}
+
+    bool empty() const { return _count == 0; }
+    size_t size() const { return _count; }
+
+    // i-ème élément à partir du premier
+    T& operator[](size_t i) { return _slots[(_head + i) & (_slots.size() - 1)]; }
+    const T& operator[](size_t i) const { return _slots[(_head + i) & (_slots.size() - 1)]; }
+
+    T& front() { return _slots[_head]; }
+    const T& front() const { return _slots[_head]; }
+
+    void push_back(const T& value)
+    {
+        if (_count == _slots.size())
+            grow();
+        _slots[(_head + _count) & (_slots.size() - 1)] = value;
+        ++_count;
+    }
+
+    void pop_front()
+    {
+        _slots[_head] = T();
+        _head = (_head + 1) & (_slots.size() - 1);
+        --_count;
+    }
+
+    // Vide la file sans rendre la capacité
+    void clear()
+    {
+        while (_count > 0)
+            pop_front();
+        _head = 0;
+    }
+};
+
+#endif
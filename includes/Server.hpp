@@ -4,74 +4,234 @@
 #include <vector>
 #include <map>
 #include <string>
-#include <poll.h>
+#include <ctime>
+#include <stdint.h>
 #include "Client.hpp"
 #include "Channel.hpp"
-
-// Serveur IRC gérant plusieurs clients avec poll()
+#include "Config.hpp"
+#include "Poller.hpp"
+#include "Mutex.hpp"
+#include "HashMap.hpp"
+#include "ObjectPool.hpp"
+#include "IrcMessage.hpp"
+
+class EventLoop;
+
+// Serveur IRC gérant plusieurs clients avec un backend poll() ou epoll
+// Les sockets sont répartis sur une ou plusieurs boucles d'événements (une par thread) ;
+// l'état partagé (channels, nicknames, commandes) est protégé par _stateLock
 class Server {
 private:
-    int _server_fd;                                // File descriptor du socket serveur
+    // Handler d'une commande IRC
+    typedef void (Server::*CommandHandler)(Client& client, const IrcMessage& msg);
+
+    // Entrée de la table de dispatch : handler, exigences et compteur d'appels
+    struct CommandEntry {
+        uint64_t key;                   // Nom en majuscules packé sur 8 octets
+        const char* name;               // Nom de la commande
+        CommandHandler handler;         // Méthode appelée
+        bool needsRegistration;         // PASS/NICK/USER doivent être complétés avant
+        size_t minParams;               // Nombre minimal de paramètres (sinon 461)
+        unsigned long calls;            // Nombre d'appels traités
+        unsigned long remoteCalls;      // Appels d'utilisateurs distants, relayés par un serveur pair
+        unsigned long bytes;            // Octets reçus pour cette commande
+        unsigned long replies;          // Messages produits en la traitant (réponses, diffusions)
+        unsigned long allocs;           // Allocations du tas pendant le traitement (build ALLOC_STATS=1)
+        unsigned long allocBytes;       // Octets alloués pendant le traitement (idem)
+    };
+
+    // Serveur du réseau, joignable par un lien direct (hops = 1) ou au-delà
+    struct RemoteServer {
+        std::string name;               // Nom tel qu'annoncé
+        Client* link;                   // Lien direct qui y mène
+        unsigned long hops;             // Sauts depuis ce serveur
+
+        RemoteServer() : link(NULL), hops(0) {}
+    };
+
+    // Lien sortant demandé par --link, retenté tant qu'il n'est pas établi (boucle 0)
+    struct LinkTarget {
+        std::string host;               // Adresse IPv4 (ou localhost)
+        int port;                       // Port client du serveur pair
+        Client* link;                   // Connexion en cours ou établie (NULL = à tenter)
+        unsigned long nextAttempt;      // Prochaine tentative (ms monotones)
+    };
+
+    // Délai entre deux tentatives d'un lien sortant (ms)
+    static const unsigned long LINK_RETRY_MS = 5000;
+
+    // Nombre de cases de la table de hachage des commandes (puissance de 2)
+    static const size_t COMMAND_SLOTS = 64;
+
+    // Cibles au plus par PRIVMSG (TARGMAX dans RPL_ISUPPORT), au-delà : ERR_TOOMANYTARGETS
+    static const size_t MAX_TARGETS = 20;
+
     int _port;                                     // Port d'écoute du serveur
     std::string _password;                         // Mot de passe de connexion
     std::string _serverName;                       // Nom du serveur pour les réponses IRC
-    std::map<int, Client*> _clients;               // Map fd -> Client* (allocation dynamique)
-    std::map<std::string, Channel*> _channels;     // Map nom -> Channel* (allocation dynamique)
-    std::vector<struct pollfd> _poll_fds;           // Liste des FD pour poll()
-    bool _running;                                 // Le serveur tourne-t-il ?
-
-    // Crée le socket serveur, le configure et le met en écoute
+    HashMap<std::string, Channel*> _channels;      // Nom replié -> Channel* (emplacements de _channelPool)
+    ObjectPool<Channel> _channelPool;              // Slabs des channels (sous _stateLock)
+    HashMap<std::string, Client*> _nicknames;      // Pseudo replié -> Client* (recherche en O(1))
+    ServerConfig _config;                          // Options de démarrage (backend, threads)
+    std::vector<EventLoop*> _loops;                // Boucles d'événements (la boucle 0 tourne dans main)
+    Mutex _stateLock;                              // Protège channels, nicknames, commandes et compteur
+    size_t _clientCount;                           // Nombre de clients connectés (toutes boucles)
+    size_t _peakClients;                           // Plus grand nombre de clients simultanés
+    time_t _startTime;                             // Démarrage du serveur (uptime)
+    int _metrics_fd;                               // Socket d'écoute de l'export des métriques (-1 = aucun)
+    std::map<int, std::string> _metricsConnections; // Connexion de l'export -> réponse restant à envoyer (vide = requête attendue, boucle 0)
+    volatile bool _running;                        // Le serveur tourne-t-il ?
+    unsigned long _floodCost;                      // Avance de l'horloge de pénalité par ligne (ms)
+    unsigned long _floodWindow;                    // Avance maximale avant ralentissement (ms, 0 = illimité)
+    std::vector<CommandEntry> _commands;           // Commandes connues
+    int _commandSlots[COMMAND_SLOTS];              // Clé packée -> index dans _commands (-1 = vide)
+    std::string _lookupKey;                        // Nom recherché replié, réutilisé d'une recherche à l'autre (sous _stateLock)
+    unsigned long _deliveryBatch;                  // Numéro du dernier lot PRIVMSG (dédoublonnage des destinataires)
+    std::vector<Client*> _links;                   // Liens établis avec les serveurs voisins (arbre couvrant)
+    HashMap<std::string, RemoteServer> _servers;   // Nom replié -> serveur distant (voisins et au-delà)
+    std::vector<LinkTarget> _linkTargets;          // Liens sortants (--link), sous _stateLock
+    ObjectPool<Client> _remotePool;                // Utilisateurs des autres serveurs (sans socket, sous _stateLock)
+    size_t _remoteUsers;                           // Nombre d'utilisateurs distants
+
+    // Crée les boucles d'événements et leurs sockets d'écoute
     void setupServer();
+    int createListener(int port, bool loopbackOnly, bool reusePort, int backlog);
 
-    // Gestion des connexions
-    void acceptNewClient();
-    void readFromClient(int poll_index);
-    void disconnectClient(int poll_index);
+    // Gestion des connexions (dans la boucle propriétaire du socket)
+    void acceptNewClients(EventLoop& loop);
+    void readFromClient(EventLoop& loop, int client_fd);
+    void writeToClient(EventLoop& loop, int client_fd);
 
-    // Parsing des commandes IRC
-    std::string extractCommand(const std::string& message);
-    std::string extractParams(const std::string& message);
+    // Traite les lignes reçues permises par le contrôle de flux (verrou d'état pris)
+    // Les autres restent dans le buffer : le client est inscrit pour reprise, sa lecture suspendue si le buffer est plein
+    void processInput(EventLoop& loop, Client* client, bool resumed = false);
+    void resumeDeferred(EventLoop& loop, const std::vector<int>& fds);
 
-    // Envoi de réponses IRC
-    void sendToClient(Client& client, const std::string& message);
-    void sendNumericReply(Client& client, const std::string& code, const std::string& message);
-    std::string getClientPrefix(Client& client);
+    // Minuteries de la boucle : enregistrement, PING du serveur, inactivité (verrou pris par expireTimers)
+    void expireTimers(EventLoop& loop, unsigned long now, std::vector<int>& expired);
+    void checkLiveness(EventLoop& loop, Client* client, unsigned long now);
+    void timeoutClient(Client* client, const std::string& reason);
 
-    // Trouve un client par son nickname (retourne NULL si pas trouvé)
-    Client* findClientByNickname(const std::string& nickname);
+    // Déconnecte un client (verrou d'état pris, depuis la boucle propriétaire du client)
+    void disconnectClient(Client* client, const std::string& reason = "Connection closed");
+
+    // Envoi de réponses IRC, écrites directement dans le buffer partagé du message
+    void sendToClient(Client& client, const std::string& message);
+    void sendNumericReply(Client& client, const char* code, const std::string& message);
+    void sendNumericReply(Client& client, const char* code, const StringRef& target, const char* text);
+    void sendNumericReply(Client& client, const char* code, const StringRef& target, const StringRef& other,
+                          const char* text);
+    void beginNumeric(MessageBuilder& out, Client& client, const char* code);
+
+    // Trouve un client par son nickname ou un channel par son nom, sans tenir compte de la casse
+    // (CaseMap) ; retourne NULL si pas trouvé
+    Client* findClientByNickname(const StringRef& nickname);
+    Channel* findChannel(const StringRef& name);
+
+    // Met à jour l'index des nicknames (changement de pseudo ou déconnexion)
+    // oldFolded : ancien pseudo replié du client (vide s'il n'en avait pas)
+    void indexNickname(Client& client, const std::string& oldFolded);
+    void unindexNickname(Client& client);
+
+    // Table de dispatch : enregistrement des commandes et recherche en temps constant
+    void initCommands();
+    void registerCommand(const char* name, CommandHandler handler, bool needsRegistration, size_t minParams);
+    CommandEntry* findCommand(const StringRef& command);
 
     // Traite une commande IRC reçue d'un client (routeur principal)
-    void processCommand(Client& client, const std::string& command);
+    // La ligne est une vue dans le buffer de réception du client (sans \r\n)
+    void processCommand(Client& client, const char* line, size_t length);
 
     // Handlers d'authentification
-    void handlePass(Client& client, const std::string& params);
-    void handleNick(Client& client, const std::string& params);
-    void handleUser(Client& client, const std::string& params);
+    void handlePass(Client& client, const IrcMessage& msg);
+    void handleNick(Client& client, const IrcMessage& msg);
+    void handleUser(Client& client, const IrcMessage& msg);
     void checkRegistration(Client& client);
 
     // Handlers de channels
-    void handleJoin(Client& client, const std::string& params);
-    void handlePart(Client& client, const std::string& params);
-    void handlePrivmsg(Client& client, const std::string& params);
-    void handleKick(Client& client, const std::string& params);
-    void handleInvite(Client& client, const std::string& params);
-    void handleTopic(Client& client, const std::string& params);
-    void handleMode(Client& client, const std::string& params);
-    void handleQuit(Client& client, const std::string& params);
-
-    // Retire un client de tous les channels quand il se déconnecte
-    void removeClientFromAllChannels(Client* client);
+    void handleJoin(Client& client, const IrcMessage& msg);
+    void handlePart(Client& client, const IrcMessage& msg);
+    void handlePrivmsg(Client& client, const IrcMessage& msg);
+    void handleKick(Client& client, const IrcMessage& msg);
+    void handleInvite(Client& client, const IrcMessage& msg);
+    void handleTopic(Client& client, const IrcMessage& msg);
+    void handleMode(Client& client, const IrcMessage& msg);
+    void handleQuit(Client& client, const IrcMessage& msg);
+
+    // Une cible d'une liste JOIN / PART / PRIVMSG
+    void joinChannel(Client& client, std::string channelName, const std::string& key);
+    void partChannel(Client& client, const std::string& requestedName, const std::string& message);
+    void deliverPrivmsg(Client& client, const StringRef& target, const IrcMessage& msg, unsigned long batch,
+                        MessageRef& relay);
+    void relayPrivmsg(Client& client, Client& link, const IrcMessage& msg, unsigned long batch, MessageRef& relay);
+
+    // Handlers serveur (opérateurs IRC, statistiques)
+    void handleOper(Client& client, const IrcMessage& msg);
+    void handleStats(Client& client, const IrcMessage& msg);
+    void handlePing(Client& client, const IrcMessage& msg);
+    void handlePong(Client& client, const IrcMessage& msg);
+
+    // Liens entre serveurs (ServerLink.cpp) : connexion, burst, propagation et netsplit
+    // Chaque serveur tient l'état complet du réseau (utilisateurs, channels) ; un utilisateur distant
+    // est un Client sans socket rattaché au lien qui y mène, dont les messages partent sur ce lien
+    void setupLinks();
+    int linkTimeout(unsigned long now, int timeout);
+    void connectLinks(EventLoop& loop, unsigned long now);
+    void sendLinkIntroduction(Client& link);
+    void establishLink(Client& link, const std::string& name, const std::string& description);
+    void sendBurst(Client& link);
+    void sendChannelBurst(Client& link, Channel& channel);
+    void dropLink(Client* link, const std::string& reason);
+    void propagate(const MessageRef& message, Client* except);
+    MessageRef userIntroduction(Client& user);
+    void propagateNick(Client& user, const std::string& oldNick, Client* except);
+    void propagateQuit(Client& user, const std::string& reason, Client* except);
+    void removeRemoteUser(Client* user, const std::string& reason);
+
+    // Commandes reçues d'un serveur pair (LinkCommands.cpp), verrou d'état pris
+    // Les commandes d'utilisateurs distants (PRIVMSG, PART, KICK, TOPIC, MODE, INVITE) passent
+    // par les handlers des clients : réponses d'erreur ignorées, propagation vers les autres liens
+    void handleServer(Client& client, const IrcMessage& msg);
+    void processLinkMessage(Client& link, const char* line, size_t length);
+    void linkServer(Client& link, const IrcMessage& msg);
+    void linkSquit(Client& link, const IrcMessage& msg);
+    void linkUser(Client& link, const IrcMessage& msg);
+    void linkNick(Client& link, Client& user, const IrcMessage& msg);
+    void linkSjoin(Client& link, const IrcMessage& msg);
+    void linkTopic(Client& link, const IrcMessage& msg);
+    bool resolveCollision(Client& link, Client* existing, time_t incomingTs);
+    void saveUser(Client& user, Client& winnerLink);
+
+    // Métriques : instantané texte (verrou d'état pris) et export local
+    std::string formatMetrics();
+    void setupMetrics();
+    void acceptMetricsConnection();
+    void answerMetricsConnection(int fd);
+    void closeMetricsConnection(int fd);
+
+    // Création/suppression d'un channel (table + pool)
+    Channel* createChannel(const std::string& name);
+    void destroyChannel(Channel* channel);
+
+    // Retire un client de ses channels (et invitations) quand il se déconnecte
+    void removeClientFromAllChannels(Client* client, const std::string& reason);
 
 public:
-    // Constructeur : initialise le serveur avec un port et un mot de passe
-    Server(int port, const std::string& password);
+    // Constructeur : initialise le serveur avec un port, un mot de passe et les options
+    Server(int port, const std::string& password, const ServerConfig& config);
 
     // Destructeur : ferme proprement tous les sockets
     ~Server();
 
-    // Lance la boucle principale du serveur (poll + traitement)
+    // Lance les boucles d'événements et attend leur arrêt
     void run();
 
+    // Boucle d'une EventLoop (attente d'événements + traitement), appelée par son thread
+    void runLoop(EventLoop& loop);
+
+    // Demande l'arrêt des boucles (sûr depuis un gestionnaire de signal)
+    void requestStop();
+
     // Arrête le serveur proprement
     void stop();
 };
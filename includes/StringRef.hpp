@@ -0,0 +1,39 @@
+#ifndef STRINGREF_HPP
+#define STRINGREF_HPP
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+
+// Vue (pointeur + longueur) sur des caractères appartenant à un autre buffer, sans copie
+// Reste valide tant que le buffer d'origine n'est pas modifié
+struct StringRef {
+    const char* data;
+    size_t length;
+
+    StringRef() : data(""), length(0) {}
+    StringRef(const char* d, size_t len) : data(d), length(len) {}
+    StringRef(const std::string& s) : data(s.data()), length(s.size()) {}
+
+    bool empty() const { return length == 0; }
+    size_t size() const { return length; }
+    char operator[](size_t i) const { return data[i]; }
+
+    // Copie la vue dans une std::string (seulement quand une copie est vraiment nécessaire)
+    std::string str() const { return std::string(data, length); }
+
+    // Compare avec une chaîne C (sensible à la casse)
+    bool operator==(const char* other) const
+    {
+        return std::strlen(other) == length && std::memcmp(data, other, length) == 0;
+    }
+
+    bool operator==(const StringRef& other) const
+    {
+        return other.length == length && std::memcmp(data, other.data, length) == 0;
+    }
+
+    bool operator!=(const char* other) const { return !(*this == other); }
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Minuterie intrusive : embarquée dans l'objet surveillé (aucune allocation pour l'armer)
+struct TimerNode {
+    TimerNode* prev;            // Voisins dans la case de la roue (NULL = non armée)
+    TimerNode* next;
+    unsigned long expires;      // Échéance (ms monotones)
+    int id;                     // Identifiant rendu à l'expiration (fd du client)
+
+    TimerNode();
+
+    // Retourne true si la minuterie est armée dans une roue
+    bool isScheduled() const;
+};
+
+// Roue de minuteries hachée : chaque case couvre TICK_MS, une échéance tombe dans la case
+// (échéance / TICK_MS) % SLOTS ; armer, annuler et expirer une minuterie coûtent O(1)
+// Une minuterie au-delà d'un tour reste dans sa case jusqu'au tour de son échéance
+// Non thread-safe : chaque boucle d'événements possède sa roue
+class TimerWheel {
+public:
+    static const size_t SLOTS = 256;
+    static const unsigned long TICK_MS = 250;
+
+private:
+    TimerNode _slots[SLOTS];    // Sentinelles des listes circulaires de chaque case
+    unsigned long _nextTick;    // Première case pas encore entièrement écoulée
+    size_t _count;              // Minuteries armées
+
+    TimerWheel(const TimerWheel&);
+    TimerWheel& operator=(const TimerWheel&);
+
+    // Retire la minuterie de sa case (elle doit être armée)
+    void unlink(TimerNode& node);
+
+public:
+    // La roue démarre à l'instant now (ms monotones)
+    explicit TimerWheel(unsigned long now);
+
+    // Arme (ou réarme) une minuterie ; une échéance passée expire au prochain advance()
+    void schedule(TimerNode& node, unsigned long expires);
+
+    // Désarme une minuterie (sans effet si elle ne l'est pas)
+    void cancel(TimerNode& node);
+
+    // Expire les minuteries échues des cases écoulées jusqu'à now et ajoute leurs id à expired
+    void advance(unsigned long now, std::vector<int>& expired);
+
+    // Délai (ms) jusqu'à la fin de la prochaine case non vide, pour wait() (-1 si aucune minuterie)
+    int timeout(unsigned long now) const;
+
+    // Nombre de minuteries armées
+    size_t size() const;
+};
+
+#endif
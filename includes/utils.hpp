@@ -9,4 +9,7 @@ bool set_nonblocking(int fd);
 // Affiche un message d'erreur et quitte le programme
 void error_exit(const std::string& message);
 
+// Horloge monotone en millisecondes (insensible aux changements de l'heure système)
+unsigned long monotonic_ms();
+
 #endif
\ No newline at end of file
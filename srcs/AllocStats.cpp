@@ -0,0 +1,94 @@
+#include "AllocStats.hpp"
+#include <cstdlib>  // Pour std::malloc(), std::free()
+#include <new>      // Pour std::bad_alloc, std::nothrow_t
+
+AllocCounters::AllocCounters() : count(0), bytes(0)
+{
+}
+
+#ifdef IRC_ALLOC_STATS
+
+// Compteurs du thread courant (TLS : rien de partagé sur le chemin d'allocation)
+static __thread unsigned long t_allocCount = 0;
+static __thread unsigned long t_allocBytes = 0;
+
+// Alloue et compte (une taille nulle doit tout de même rendre un pointeur unique)
+static void* countedAlloc(size_t size)
+{
+    ++t_allocCount;
+    t_allocBytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+    void* ptr = countedAlloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+    void* ptr = countedAlloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw()
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) throw()
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) throw()
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) throw()
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) throw()
+{
+    std::free(ptr);
+}
+
+bool AllocStats::enabled()
+{
+    return true;
+}
+
+AllocCounters AllocStats::current()
+{
+    AllocCounters counters;
+    counters.count = t_allocCount;
+    counters.bytes = t_allocBytes;
+    return counters;
+}
+
+#else
+
+bool AllocStats::enabled()
+{
+    return false;
+}
+
+AllocCounters AllocStats::current()
+{
+    return AllocCounters();
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "CaseMap.hpp"
+#ifdef __SSE2__
+# include <emmintrin.h>  // Pour les intrinsèques SSE2 (_mm_*)
+#endif
+
+// Une correspondance replie une plage contiguë 'A'..last en lui ajoutant 0x20 :
+// 'Z' pour ascii, '^' pour rfc1459 ([ \ ] ^ suivent Z et deviennent { | } ~)
+static CaseMapping g_mapping = CASEMAP_RFC1459;
+static unsigned char g_last = '^';
+
+// Table octet -> octet replié (fin des noms, et noms trop courts pour le noyau vectoriel)
+static unsigned char g_table[256];
+
+// Remplit la table pour la plage 'A'..last
+static bool buildTable(unsigned char last)
+{
+    for (int c = 0; c < 256; ++c)
+        g_table[c] = (unsigned char)(c >= 'A' && c <= last ? c + 0x20 : c);
+    return true;
+}
+
+static bool g_tableReady = buildTable(g_last);
+
+bool CaseMap::parse(const std::string& name, CaseMapping& mapping)
+{
+    if (name == "rfc1459")
+        mapping = CASEMAP_RFC1459;
+    else if (name == "ascii")
+        mapping = CASEMAP_ASCII;
+    else
+        return false;
+    return true;
+}
+
+void CaseMap::set(CaseMapping mapping)
+{
+    g_mapping = mapping;
+    g_last = mapping == CASEMAP_ASCII ? 'Z' : '^';
+    g_tableReady = buildTable(g_last);
+}
+
+CaseMapping CaseMap::get()
+{
+    return g_mapping;
+}
+
+const char* CaseMap::name()
+{
+    return g_mapping == CASEMAP_ASCII ? "ascii" : "rfc1459";
+}
+
+// Noyau SSE2 : 16 octets par itération, sans branche ni accès à la table
+// c est replié si (c - 'A') <= last - 'A' en non signé ; SSE2 ne compare qu'en signé,
+// d'où le décalage de 0x80 des deux côtés : (c - 'A' - 0x80) < (last - 'A' + 1 - 0x80)
+void CaseMap::fold(const char* in, size_t length, char* out)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i base = _mm_set1_epi8((char)('A' + 0x80));
+    const __m128i limit = _mm_set1_epi8((char)(g_last - 'A' + 1 - 0x80));
+    const __m128i delta = _mm_set1_epi8(0x20);
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i inRange = _mm_cmplt_epi8(_mm_sub_epi8(bytes, base), limit);
+        bytes = _mm_add_epi8(bytes, _mm_and_si128(inRange, delta));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), bytes);
+    }
+#endif
+    for (; i < length; ++i)
+        out[i] = (char)g_table[(unsigned char)in[i]];
+}
+
+void CaseMap::fold(const char* in, size_t length, std::string& out)
+{
+    out.resize(length);
+    if (length > 0)
+        fold(in, length, &out[0]);
+}
+
+std::string CaseMap::fold(const std::string& text)
+{
+    std::string folded;
+    fold(text.data(), text.size(), folded);
+    return folded;
+}
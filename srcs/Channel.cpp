@@ -1,33 +1,48 @@
 #include "Channel.hpp"
 #include "Client.hpp"
-#include <sys/socket.h>  // Pour send()
-#include <algorithm>     // Pour std::find()
+#include "MessageBuffer.hpp"
+#include "CaseMap.hpp"
 #include <iostream>      // Pour std::cout, std::cerr
+#include <sstream>       // Pour std::ostringstream
 
 // Constructeur : initialise un channel avec son nom et les modes par défaut
-Channel::Channel(const std::string& name) : _name(name), _inviteOnly(false), _topicRestricted(false), _userLimit(0)
+Channel::Channel(const std::string& name) : _name(name), _foldedName(CaseMap::fold(name)), _inviteOnly(false), _topicRestricted(false), _userLimit(0),
+      _createdAt(time(NULL)), _namesBytes(0), _peakMembers(0), _broadcasts(0)
 {
 }
 
-// Destructeur
+// Destructeur : retire le channel des index inverses des clients qui le référencent encore
 Channel::~Channel()
 {
+    for (HashMap<Client*, MemberRecord>::iterator it = _records.begin(); it != _records.end(); ++it)
+    {
+        if (it->second.flags & MEMBER_JOINED)
+            it->first->removeChannel(this);
+        if (it->second.flags & MEMBER_INVITED)
+            it->first->removeInvitation(this);
+    }
 }
 
 // Retourne le nom du channel
-std::string Channel::getName() const
+const std::string& Channel::getName() const
 {
     return _name;
 }
 
+// Retourne le nom replié du channel (comparaisons insensibles à la casse)
+const std::string& Channel::getFoldedName() const
+{
+    return _foldedName;
+}
+
 // Retourne le sujet du channel
-std::string Channel::getTopic() const
+const std::string& Channel::getTopic() const
 {
     return _topic;
 }
 
 // Retourne le mot de passe du channel
-std::string Channel::getKey() const
+const std::string& Channel::getKey() const
 {
     return _key;
 }
@@ -51,11 +66,58 @@ int Channel::getUserLimit() const
 }
 
 // Retourne la liste des membres du channel
-std::vector<Client*>& Channel::getMembers()
+const std::vector<Client*>& Channel::getMembers() const
 {
     return _members;
 }
 
+// Retourne l'horodatage du channel
+time_t Channel::getCreatedAt() const
+{
+    return _createdAt;
+}
+
+// Retourne les liens menant à des membres distants
+const std::vector<std::pair<Client*, size_t> >& Channel::getLinks() const
+{
+    return _links;
+}
+
+// Construit la chaîne des modes actifs et de leurs paramètres
+void Channel::formatModes(std::string& modes, std::string& params) const
+{
+    modes = "+";
+    params.clear();
+    if (_inviteOnly)
+        modes += 'i';
+    if (_topicRestricted)
+        modes += 't';
+    if (!_key.empty())
+    {
+        modes += 'k';
+        params += " " + _key;
+    }
+    if (_userLimit > 0)
+    {
+        modes += 'l';
+        std::ostringstream oss;
+        oss << " " << _userLimit;
+        params += oss.str();
+    }
+}
+
+// Retourne le plus grand nombre de membres atteint
+size_t Channel::getPeakMembers() const
+{
+    return _peakMembers;
+}
+
+// Retourne le nombre de messages diffusés dans le channel
+unsigned long Channel::getBroadcasts() const
+{
+    return _broadcasts;
+}
+
 // Définit le sujet du channel
 void Channel::setTopic(const std::string& topic)
 {
@@ -86,30 +148,233 @@ void Channel::setUserLimit(int limit)
     _userLimit = limit;
 }
 
+// Définit l'horodatage du channel (SJOIN plus ancien reçu d'un serveur pair)
+void Channel::setCreatedAt(time_t createdAt)
+{
+    _createdAt = createdAt;
+}
+
+// Tient à jour le nombre de membres distants par lien (entrée retirée à zéro)
+void Channel::countLink(Client* link, bool added)
+{
+    for (size_t i = 0; i < _links.size(); ++i)
+    {
+        if (_links[i].first != link)
+            continue;
+        if (added)
+            ++_links[i].second;
+        else if (--_links[i].second == 0)
+        {
+            _links[i] = _links.back();
+            _links.pop_back();
+        }
+        return;
+    }
+    if (added)
+        _links.push_back(std::make_pair(link, (size_t)1));
+}
+
 // --- Gestion des membres ---
 
+// Retourne le statut d'un client dans le channel (0 s'il n'y a pas de fiche)
+unsigned char Channel::getMemberFlags(Client* client) const
+{
+    const MemberRecord* record = _records.find(client);
+    return record ? record->flags : 0;
+}
+
+// Active ou désactive un bit de statut ; la fiche disparaît quand plus aucun bit n'est actif
+void Channel::setFlag(Client* client, unsigned char flag, bool enabled)
+{
+    MemberRecord* record = _records.find(client);
+    if (!record)
+    {
+        if (!enabled)
+            return;
+        MemberRecord created;
+        created.flags = flag;
+        _records.set(client, created);
+        return;
+    }
+
+    if (enabled)
+        record->flags |= flag;
+    else
+        record->flags &= ~flag;
+
+    if (record->flags == 0)
+        _records.erase(client);
+}
+
+// --- Réponse NAMES (353) ---
+
+// Retourne les lignes pré-rendues de la réponse NAMES
+const std::vector<std::string>& Channel::getNamesLines() const
+{
+    return _namesLines;
+}
+
+// Pseudo tel qu'affiché dans NAMES (préfixé de @ pour un opérateur)
+std::string Channel::namesToken(Client* client, unsigned char flags)
+{
+    if (flags & MEMBER_OPERATOR)
+        return "@" + client->getNickname();
+    return client->getNickname();
+}
+
+// Octets de pseudos disponibles par ligne : 353 = ":<serveur> 353 <pseudo> = <channel> :<pseudos>"
+// (le serveur n'accepte pas de nom de channel de plus de NAME_LENGTH caractères)
+size_t Channel::namesBudget() const
+{
+    return LINE_LENGTH - NAMES_RESERVED - _name.size();
+}
+
+// Ajoute le pseudo à la dernière ligne s'il y tient, sinon ouvre une nouvelle ligne
+void Channel::namesAppend(MemberRecord& record, const std::string& token)
+{
+    if (_namesLines.empty() || (!_namesLines.back().empty()
+        && _namesLines.back().size() + 1 + token.size() > namesBudget()))
+        _namesLines.push_back(std::string());
+
+    std::string& line = _namesLines.back();
+    if (!line.empty())
+        line += ' ';
+    line += token;
+    record.namesLine = _namesLines.size() - 1;
+    _namesBytes += token.size();
+}
+
+// Retire le pseudo de sa ligne (parcours d'une seule ligne, moins de 512 octets)
+bool Channel::namesErase(MemberRecord& record, const std::string& token)
+{
+    std::string& line = _namesLines[record.namesLine];
+    size_t start = 0;
+    while (start < line.size())
+    {
+        size_t end = line.find(' ', start);
+        if (end == std::string::npos)
+            end = line.size();
+
+        if (line.compare(start, end - start, token) == 0)
+        {
+            // Retirer aussi un séparateur (celui qui suit, ou celui qui précède en fin de ligne)
+            if (end < line.size())
+                line.erase(start, end - start + 1);
+            else
+                line.erase(start > 0 ? start - 1 : 0, end - start + (start > 0 ? 1 : 0));
+            _namesBytes -= token.size();
+            break;
+        }
+        start = end + 1;
+    }
+
+    // Trop de lignes peu remplies : on reconstruit (coût amorti sur les retraits qui l'ont causé)
+    if (_namesLines.size() <= 2 * (_namesBytes / namesBudget() + 1))
+        return false;
+    namesRebuild();
+    return true;
+}
+
+// Remplace le pseudo sur place, ou le déplace s'il ne tient plus dans sa ligne
+void Channel::namesReplace(MemberRecord& record, const std::string& oldToken, const std::string& newToken)
+{
+    std::string& line = _namesLines[record.namesLine];
+    if (line.size() - oldToken.size() + newToken.size() <= namesBudget())
+    {
+        size_t start = 0;
+        while (start < line.size())
+        {
+            size_t end = line.find(' ', start);
+            if (end == std::string::npos)
+                end = line.size();
+            if (line.compare(start, end - start, oldToken) == 0)
+            {
+                line.replace(start, end - start, newToken);
+                _namesBytes += newToken.size();
+                _namesBytes -= oldToken.size();
+                return;
+            }
+            start = end + 1;
+        }
+    }
+
+    // Après une reconstruction complète, le nouveau pseudo y figure déjà
+    if (!namesErase(record, oldToken))
+        namesAppend(record, newToken);
+}
+
+// Reconstruit toutes les lignes à partir des membres (O(membres))
+void Channel::namesRebuild()
+{
+    _namesLines.clear();
+    _namesBytes = 0;
+    for (size_t i = 0; i < _members.size(); ++i)
+    {
+        MemberRecord* record = _records.find(_members[i]);
+        namesAppend(*record, namesToken(_members[i], record->flags));
+    }
+}
+
+// Met à jour le pseudo d'un membre après un changement de NICK
+void Channel::renameMember(Client* client, const std::string& oldNick)
+{
+    MemberRecord* record = _records.find(client);
+    if (!record || !(record->flags & MEMBER_JOINED))
+        return;
+
+    std::string oldToken = (record->flags & MEMBER_OPERATOR) ? "@" + oldNick : oldNick;
+    namesReplace(*record, oldToken, namesToken(client, record->flags));
+}
+
 // Ajoute un client à la liste des membres du channel
 void Channel::addMember(Client* client)
 {
-    if (!isMember(client))
-        _members.push_back(client);
+    if (isMember(client))
+        return;
+
+    setFlag(client, MEMBER_JOINED, true);
+    MemberRecord* record = _records.find(client);
+    record->index = _members.size();
+    _members.push_back(client);
+    namesAppend(*record, namesToken(client, record->flags));
+    if (_members.size() > _peakMembers)
+        _peakMembers = _members.size();
+    if (client->isRemote())
+        countLink(client->getUplink(), true);
+    client->addChannel(this);
 }
 
-// Retire un client de la liste des membres du channel
+// Retire un client du channel en O(1) : le dernier membre prend sa place
 void Channel::removeMember(Client* client)
 {
-    std::vector<Client*>::iterator it = std::find(_members.begin(), _members.end(), client);
-    if (it != _members.end())
-        _members.erase(it);
+    MemberRecord* record = _records.find(client);
+    if (!record)
+        return;
 
-    removeOperator(client);
-    removeInvited(client);
+    if (record->flags & MEMBER_JOINED)
+    {
+        size_t index = record->index;
+        Client* last = _members.back();
+        _members[index] = last;
+        _members.pop_back();
+        if (last != client)
+            _records.find(last)->index = index;
+        namesErase(*record, namesToken(client, record->flags));
+        if (client->isRemote())
+            countLink(client->getUplink(), false);
+        client->removeChannel(this);
+    }
+
+    if (record->flags & MEMBER_INVITED)
+        client->removeInvitation(this);
+
+    _records.erase(client);
 }
 
 // Vérifie si un client est membre du channel
 bool Channel::isMember(Client* client) const
 {
-    return std::find(_members.begin(), _members.end(), client) != _members.end();
+    return (getMemberFlags(client) & MEMBER_JOINED) != 0;
 }
 
 // --- Gestion des opérateurs ---
@@ -117,22 +382,32 @@ bool Channel::isMember(Client* client) const
 // Ajoute un client comme opérateur du channel
 void Channel::addOperator(Client* client)
 {
-    if (!isOperator(client))
-        _operators.push_back(client);
+    if (isOperator(client))
+        return;
+    setFlag(client, MEMBER_OPERATOR, true);
+
+    // Membre : son pseudo devient @pseudo dans la réponse NAMES
+    MemberRecord* record = _records.find(client);
+    if (record->flags & MEMBER_JOINED)
+        namesReplace(*record, client->getNickname(), namesToken(client, record->flags));
 }
 
 // Retire un client de la liste des opérateurs
 void Channel::removeOperator(Client* client)
 {
-    std::vector<Client*>::iterator it = std::find(_operators.begin(), _operators.end(), client);
-    if (it != _operators.end())
-        _operators.erase(it);
+    if (!isOperator(client))
+        return;
+    setFlag(client, MEMBER_OPERATOR, false);
+
+    MemberRecord* record = _records.find(client);
+    if (record && (record->flags & MEMBER_JOINED))
+        namesReplace(*record, "@" + client->getNickname(), namesToken(client, record->flags));
 }
 
 // Vérifie si un client est opérateur du channel
 bool Channel::isOperator(Client* client) const
 {
-    return std::find(_operators.begin(), _operators.end(), client) != _operators.end();
+    return (getMemberFlags(client) & MEMBER_OPERATOR) != 0;
 }
 
 // --- Gestion des invitations ---
@@ -140,22 +415,27 @@ bool Channel::isOperator(Client* client) const
 // Ajoute un client à la liste des invités du channel
 void Channel::addInvited(Client* client)
 {
-    if (!isInvited(client))
-        _invited.push_back(client);
+    if (isInvited(client))
+        return;
+
+    setFlag(client, MEMBER_INVITED, true);
+    client->addInvitation(this);
 }
 
 // Vérifie si un client est dans la liste des invités
 bool Channel::isInvited(Client* client) const
 {
-    return std::find(_invited.begin(), _invited.end(), client) != _invited.end();
+    return (getMemberFlags(client) & MEMBER_INVITED) != 0;
 }
 
 // Retire un client de la liste des invités
 void Channel::removeInvited(Client* client)
 {
-    std::vector<Client*>::iterator it = std::find(_invited.begin(), _invited.end(), client);
-    if (it != _invited.end())
-        _invited.erase(it);
+    if (!isInvited(client))
+        return;
+
+    setFlag(client, MEMBER_INVITED, false);
+    client->removeInvitation(this);
 }
 
 // --- Envoi de messages ---
@@ -163,22 +443,46 @@ void Channel::removeInvited(Client* client)
 // Envoie un message à tous les membres du channel sauf l'expéditeur
 void Channel::broadcastMessage(const std::string& message, Client* sender)
 {
+    broadcastMessage(MessageRef(message), sender);
+}
+
+// Envoie un message déjà sérialisé à tous les membres sauf l'expéditeur (une seule copie partagée)
+void Channel::broadcastMessage(const MessageRef& message, Client* sender)
+{
+    ++_broadcasts;
     for (size_t i = 0; i < _members.size(); ++i)
     {
-        // Ne pas envoyer le message à l'expéditeur
-        if (_members[i] != sender)
-        {
-            send(_members[i]->getFd(), message.c_str(), message.length(), 0);
-        }
+        // Ne pas envoyer le message à l'expéditeur ni aux membres distants
+        if (_members[i] != sender && !_members[i]->isRemote())
+            _members[i]->queueMessage(message);
+    }
+}
+
+// Envoie un message aux membres sauf l'expéditeur, en sautant ceux déjà servis dans le lot
+void Channel::broadcastMessageOnce(const MessageRef& message, Client* sender, unsigned long batch)
+{
+    ++_broadcasts;
+    for (size_t i = 0; i < _members.size(); ++i)
+    {
+        if (_members[i] != sender && !_members[i]->isRemote() && _members[i]->markDelivered(batch))
+            _members[i]->queueMessage(message);
     }
 }
 
 // Envoie un message à TOUS les membres du channel (y compris l'expéditeur)
 void Channel::broadcastMessageAll(const std::string& message)
 {
+    broadcastMessageAll(MessageRef(message));
+}
+
+// Envoie un message déjà sérialisé à TOUS les membres (une seule copie partagée)
+void Channel::broadcastMessageAll(const MessageRef& message)
+{
+    ++_broadcasts;
     for (size_t i = 0; i < _members.size(); ++i)
     {
-        // Envoyer le message via le socket du membre
-        send(_members[i]->getFd(), message.c_str(), message.length(), 0);
+        // Mettre le message dans la file d'envoi du membre (local)
+        if (!_members[i]->isRemote())
+            _members[i]->queueMessage(message);
     }
 }
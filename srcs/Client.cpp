@@ -1,8 +1,21 @@
 #include "Client.hpp"
+#include "Poller.hpp"
+#include "EventLoop.hpp"
+#include "CaseMap.hpp"
+#include <sys/uio.h>     // Pour writev(), struct iovec
+#include <cerrno>        // Pour errno
+
+// Nombre maximal de messages regroupés dans un seul writev()
+static const int MAX_IOV = 64;
 
 // Constructeur : initialise un nouveau client avec son file descriptor
-Client::Client(int fd) : _fd(fd), _authenticated(false), _registered(false)
+Client::Client(int fd, EventLoop* loop)
+    : _fd(fd), _authenticated(false), _registered(false), _ircOperator(false), _linkAuthenticated(false),
+      _serverLink(false), _outboundLink(false), _uplink(NULL), _hops(0), _nickTs(0), _outOffset(0), _outBytes(0), _loop(loop),
+      _writeInterest(false), _closing(false), _flushPending(false), _penaltyClock(0), _deferred(false), _readPaused(false),
+      _lastActivity(0), _lastCommand(0), _pingPending(false), _deliveryBatch(0), _bytesQueued(0), _bytesFlushed(0)
 {
+    _timer.id = fd;
 }
 
 // Destructeur
@@ -16,22 +29,40 @@ int Client::getFd() const
     return (_fd);
 }
 
+// Retourne la boucle propriétaire du client
+EventLoop* Client::getLoop() const
+{
+    return (_loop);
+}
+
 // Retourne le pseudo du client
-std::string Client::getNickname() const
+const std::string& Client::getNickname() const
 {
     return (_nickname);
 }
 
 // Retourne le nom d'utilisateur du client
-std::string Client::getUsername() const
+const std::string& Client::getUsername() const
 {
     return (_username);
 }
 
-// Retourne le buffer de données reçues
-std::string Client::getBuffer() const
+// Retourne le pseudo replié (comparaisons insensibles à la casse)
+const std::string& Client::getFoldedNickname() const
 {
-    return (_buffer);
+    return (_foldedNickname);
+}
+
+// Retourne le préfixe IRC du client (:nick!user@localhost), sans le recalculer
+const std::string& Client::getPrefix() const
+{
+    return (_prefix);
+}
+
+// Retourne le buffer de réception (recv() écrit directement dedans)
+LineBuffer& Client::getRecvBuffer()
+{
+    return (_recvBuffer);
 }
 
 // Retourne true si le client a fourni le bon mot de passe
@@ -46,16 +77,37 @@ bool Client::isRegistered() const
     return (_registered);
 }
 
+// Vérifie si le client est opérateur IRC (OPER)
+bool Client::isIrcOperator() const
+{
+    return (_ircOperator);
+}
+
 // Définit le pseudo du client
 void Client::setNickname(const std::string& nickname)
 {
     _nickname = nickname;
+    CaseMap::fold(nickname.data(), nickname.size(), _foldedNickname);
+    updatePrefix();
 }
 
 // Définit le nom d'utilisateur du client
 void Client::setUsername(const std::string& username)
 {
     _username = username;
+    updatePrefix();
+}
+
+// Construit le préfixe une fois pour tous les messages émis par ce client
+void Client::updatePrefix()
+{
+    _prefix.clear();
+    _prefix.reserve(_nickname.size() + _username.size() + 12);
+    _prefix += ':';
+    _prefix += _nickname;
+    _prefix += '!';
+    _prefix += _username;
+    _prefix += "@localhost";
 }
 
 // Marque le client comme authentifié (ou non)
@@ -70,14 +122,437 @@ void Client::setRegistered(bool reg)
     _registered = reg;
 }
 
-// Ajoute des données au buffer (accumulation des données reçues)
-void Client::appendToBuffer(const std::string& data)
+// Marque le client comme opérateur IRC
+void Client::setIrcOperator(bool oper)
+{
+    _ircOperator = oper;
+}
+
+// --- Réseau de serveurs ---
+
+// Retourne true si la connexion a présenté le mot de passe des liens
+bool Client::isLinkAuthenticated() const
+{
+    return (_linkAuthenticated);
+}
+
+// Retourne true si la connexion est un lien établi avec un autre serveur
+bool Client::isServerLink() const
+{
+    return (_serverLink);
+}
+
+// Retourne true si la connexion a été ouverte par ce serveur vers un pair de --link
+bool Client::isOutboundLink() const
+{
+    return (_outboundLink);
+}
+
+// Retourne true pour un utilisateur d'un autre serveur (aucun socket, joignable par un lien)
+bool Client::isRemote() const
+{
+    return (_uplink != NULL);
+}
+
+// Retourne le lien menant à l'utilisateur distant (NULL s'il est local)
+Client* Client::getUplink() const
+{
+    return (_uplink);
+}
+
+// Retourne le serveur de l'utilisateur (ou le serveur pair d'un lien)
+const std::string& Client::getServerName() const
+{
+    return (_serverName);
+}
+
+// Retourne le nombre de sauts jusqu'au serveur de l'utilisateur
+unsigned long Client::getHops() const
+{
+    return (_hops);
+}
+
+// Retourne l'horodatage du pseudo
+time_t Client::getNickTs() const
+{
+    return (_nickTs);
+}
+
+// Marque la connexion comme candidate à un lien serveur (ou non)
+void Client::setLinkAuthenticated(bool auth)
+{
+    _linkAuthenticated = auth;
+}
+
+// Marque la connexion comme lien serveur établi
+void Client::setServerLink(bool link)
+{
+    _serverLink = link;
+}
+
+// Marque la connexion comme lien sortant (--link)
+void Client::setOutboundLink(bool outbound)
+{
+    _outboundLink = outbound;
+}
+
+// Rattache un utilisateur distant au lien qui y mène
+void Client::setUplink(Client* uplink)
+{
+    _uplink = uplink;
+}
+
+// Définit le serveur de l'utilisateur (ou le serveur pair d'un lien)
+void Client::setServerName(const std::string& name)
+{
+    _serverName = name;
+}
+
+// Définit le nombre de sauts jusqu'au serveur de l'utilisateur
+void Client::setHops(unsigned long hops)
+{
+    _hops = hops;
+}
+
+// Définit l'horodatage du pseudo (enregistrement ou changement de pseudo)
+void Client::setNickTs(time_t ts)
+{
+    _nickTs = ts;
+}
+
+// --- File d'envoi ---
+
+// Met un message en file d'envoi sans jamais bloquer ni perdre de données
+void Client::queueMessage(const std::string& message)
+{
+    if (message.empty())
+        return;
+    queueMessage(MessageRef(message));
+}
+
+// Ajoute une référence au message partagé dans la file (aucune copie des octets)
+void Client::queueMessage(const MessageRef& message)
+{
+    if (message.empty())
+        return;
+
+    // Utilisateur distant : le message part sur le lien qui y mène (le serveur pair le remet)
+    if (_uplink)
+    {
+        _uplink->queueMessage(message);
+        return;
+    }
+
+    // Compté par la boucle qui produit le message (attribué à la commande en cours)
+    EventLoop* here = EventLoop::current();
+    if (here)
+        ++here->getStats().messagesOut;
+
+    // Client d'une autre boucle : seule sa boucle touche sa file d'envoi
+    if (_loop && here && here != _loop)
+    {
+        here->stage(this, message);
+        return;
+    }
+
+    deliver(message);
+}
+
+// Ajoute la référence à la file d'envoi ; l'envoi est différé à la fin du tour de boucle
+void Client::deliver(const MessageRef& message)
+{
+    if (_closing)
+        return;
+
+    _outQueue.push_back(message);
+    _outBytes += message.size();
+    _bytesQueued += message.size();
+
+    // Un lecteur trop lent ne doit pas faire grossir la mémoire indéfiniment
+    if (_outBytes > MAX_SENDQ)
+    {
+        _closing = true;
+        _outQueue.clear();
+        _outOffset = 0;
+        _outBytes = 0;
+        updateWriteInterest();
+        return;
+    }
+
+    // Toutes les réponses produites pendant ce tour partiront en un seul writev()
+    // (sans boucle, comme dans les microbenchmarks, l'envoi est immédiat)
+    if (!_loop)
+        flushOutput();
+    else if (!_flushPending && !_writeInterest)
+        _loop->scheduleFlush(this);
+}
+
+// Retourne true si le client est inscrit pour l'envoi groupé de ce tour
+bool Client::isFlushPending() const
+{
+    return _flushPending;
+}
+
+// Marque le client comme inscrit (ou non) pour l'envoi groupé
+void Client::setFlushPending(bool pending)
+{
+    _flushPending = pending;
+}
+
+// Envoie les messages en attente avec writev() jusqu'à vider la file ou remplir le socket
+bool Client::flushOutput()
+{
+    while (!_outQueue.empty())
+    {
+        // Regrouper plusieurs messages de la file dans un seul appel système
+        struct iovec iov[MAX_IOV];
+        int count = 0;
+        size_t total = 0;
+        size_t offset = _outOffset;
+        for (size_t i = 0; i < _outQueue.size() && count < MAX_IOV; ++i)
+        {
+            const MessageRef& message = _outQueue[i];
+            iov[count].iov_base = const_cast<char*>(message.data() + offset);
+            iov[count].iov_len = message.size() - offset;
+            total += iov[count].iov_len;
+            offset = 0;
+            ++count;
+        }
+
+        ssize_t sent = writev(_fd, iov, count);
+        if (_loop)
+            ++_loop->getStats().writes;
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                if (_loop)
+                    ++_loop->getStats().shortWrites;
+                break;
+            }
+            _closing = true;
+            _outQueue.clear();
+            _outOffset = 0;
+            _outBytes = 0;
+            updateWriteInterest();
+            return false;
+        }
+        _bytesFlushed += sent;
+        _outBytes -= sent;
+        if (_loop)
+            _loop->getStats().bytesOut += sent;
+
+        // Retirer les messages entièrement envoyés, avancer dans le premier restant
+        size_t left = sent;
+        while (left > 0)
+        {
+            size_t available = _outQueue.front().size() - _outOffset;
+            if (left < available)
+            {
+                _outOffset += left;
+                break;
+            }
+            left -= available;
+            _outQueue.pop_front();
+            _outOffset = 0;
+        }
+
+        // Écriture partielle : le socket est plein, on attendra POLLOUT
+        if ((size_t)sent < total)
+        {
+            if (_loop)
+                ++_loop->getStats().shortWrites;
+            break;
+        }
+    }
+
+    updateWriteInterest();
+    return true;
+}
+
+// POLLOUT n'est demandé que tant que la file n'est pas vide (ou qu'une fermeture est en attente)
+void Client::updateWriteInterest()
+{
+    bool wanted = _closing || hasPendingOutput();
+    if (wanted == _writeInterest || !_loop)
+        return;
+    if (_loop->getPoller()->setWriteInterest(_fd, wanted))
+        _writeInterest = wanted;
+}
+
+// Retourne true s'il reste des données en attente d'envoi
+bool Client::hasPendingOutput() const
+{
+    return !_outQueue.empty();
+}
+
+// Retourne le nombre d'octets en attente d'envoi
+size_t Client::getPendingBytes() const
+{
+    return _outBytes;
+}
+
+// Retourne true si le client doit être déconnecté
+bool Client::isClosing() const
+{
+    return _closing;
+}
+
+// Retourne le nombre total d'octets mis en file
+unsigned long Client::getBytesQueued() const
+{
+    return _bytesQueued;
+}
+
+// Retourne le nombre total d'octets envoyés
+unsigned long Client::getBytesFlushed() const
+{
+    return _bytesFlushed;
+}
+
+// --- Contrôle de flux ---
+
+// L'horloge de pénalité a-t-elle moins de window ms d'avance sur now ?
+bool Client::canProcessLine(unsigned long now, unsigned long window) const
+{
+    if (window == 0 || _penaltyClock <= now)
+        return true;
+    return _penaltyClock - now < window;
+}
+
+// Compte une ligne traitée : l'horloge ne reste jamais dans le passé
+void Client::chargeLine(unsigned long now, unsigned long cost)
+{
+    if (_penaltyClock < now)
+        _penaltyClock = now;
+    _penaltyClock += cost;
+}
+
+// Premier instant où canProcessLine() redevient vrai
+unsigned long Client::nextLineTime(unsigned long window) const
 {
-    _buffer += data;
+    if (_penaltyClock < window)
+        return 0;
+    return _penaltyClock - window + 1;
 }
 
-// Vide complètement le buffer
-void Client::clearBuffer()
+// Retourne true si le client attend sa reprise par la boucle
+bool Client::isDeferred() const
 {
-    _buffer.clear();
-}
\ No newline at end of file
+    return _deferred;
+}
+
+// Marque le client comme inscrit (ou non) dans la liste de reprise de sa boucle
+void Client::setDeferred(bool deferred)
+{
+    _deferred = deferred;
+}
+
+// POLLIN est retiré tant que le buffer de réception est plein de lignes en attente
+void Client::pauseReading(bool paused)
+{
+    if (paused == _readPaused || !_loop)
+        return;
+    if (_loop->getPoller()->setReadInterest(_fd, !paused))
+        _readPaused = paused;
+}
+
+// Retourne true si la lecture du socket est suspendue
+bool Client::isReadPaused() const
+{
+    return _readPaused;
+}
+
+// --- Vivacité ---
+
+// Retourne la minuterie du client (armée dans la roue de sa boucle)
+TimerNode& Client::getTimer()
+{
+    return _timer;
+}
+
+// Retourne l'instant de la dernière réception
+unsigned long Client::getLastActivity() const
+{
+    return _lastActivity;
+}
+
+// Retourne l'instant de la dernière commande autre que PING/PONG
+unsigned long Client::getLastCommand() const
+{
+    return _lastCommand;
+}
+
+// Des octets reçus prouvent que la connexion est vivante
+void Client::markActivity(unsigned long now)
+{
+    _lastActivity = now;
+    _pingPending = false;
+}
+
+// Une commande du client (hors PING/PONG) remet à zéro son inactivité
+void Client::markCommand(unsigned long now)
+{
+    _lastCommand = now;
+}
+
+// Retourne true si un PING du serveur attend sa réponse
+bool Client::isPingPending() const
+{
+    return _pingPending;
+}
+
+// Marque un PING du serveur comme envoyé (ou répondu)
+void Client::setPingPending(bool pending)
+{
+    _pingPending = pending;
+}
+
+// Note le lot courant ; un numéro de lot n'est jamais réutilisé, rien à remettre à zéro
+bool Client::markDelivered(unsigned long batch)
+{
+    if (_deliveryBatch == batch)
+        return false;
+    _deliveryBatch = batch;
+    return true;
+}
+
+// --- Index inverse des channels ---
+
+// Retourne les channels rejoints par le client
+const std::set<Channel*>& Client::getChannels() const
+{
+    return _channels;
+}
+
+// Enregistre un channel rejoint
+void Client::addChannel(Channel* channel)
+{
+    _channels.insert(channel);
+}
+
+// Oublie un channel quitté
+void Client::removeChannel(Channel* channel)
+{
+    _channels.erase(channel);
+}
+
+// Retourne les channels où le client est invité
+const std::set<Channel*>& Client::getInvitations() const
+{
+    return _invitations;
+}
+
+// Enregistre une invitation en attente
+void Client::addInvitation(Channel* channel)
+{
+    _invitations.insert(channel);
+}
+
+// Oublie une invitation (utilisée, annulée ou channel supprimé)
+void Client::removeInvitation(Channel* channel)
+{
+    _invitations.erase(channel);
+}
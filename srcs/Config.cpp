@@ -0,0 +1,278 @@
+#include "Config.hpp"
+#include "Poller.hpp"
+#include <iostream>  // Pour std::cerr
+#include <cstdlib>   // Pour std::strtol()
+#include <sys/socket.h> // Pour SOMAXCONN
+
+// Valeurs par défaut : comportement historique (poll)
+ServerConfig::ServerConfig()
+    : backend("poll"), threads(1), backlog(SOMAXCONN), acceptBudget(64), floodRate(100), floodBurst(200),
+      registrationTimeout(30), pingInterval(120), pingTimeout(60), idleTimeout(0), logLevel(LOG_INFO), caseMapping(CASEMAP_RFC1459), operName("oper"), metricsPort(0),
+      serverName("ft_irc")
+{
+}
+
+// Sépare "--nom=valeur" en nom et valeur (retourne false si le format est invalide)
+static bool splitOption(const std::string& arg, std::string& name, std::string& value)
+{
+    if (arg.size() < 3 || arg[0] != '-' || arg[1] != '-')
+        return false;
+
+    size_t equal = arg.find('=');
+    if (equal == std::string::npos)
+        return false;
+
+    name = arg.substr(2, equal - 2);
+    value = arg.substr(equal + 1);
+    return !name.empty();
+}
+
+// Convertit une valeur entière positive bornée (retourne false si invalide)
+static bool parseCount(const std::string& value, long max, size_t& result)
+{
+    if (value.empty())
+        return false;
+
+    char* end;
+    long number = std::strtol(value.c_str(), &end, 10);
+    if (*end != '\0' || number < 1 || number > max)
+        return false;
+
+    result = (size_t)number;
+    return true;
+}
+
+// Nom de serveur valide : 1 à 63 caractères, sans espace ni caractère réservé du protocole
+static bool validServerName(const std::string& name)
+{
+    if (name.empty() || name.size() > 63 || name[0] == ':')
+        return false;
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        unsigned char c = name[i];
+        if (c <= ' ' || c == ',' || c == '!' || c == '@' || c == '#' || c == '*' || c == 127)
+            return false;
+    }
+    return true;
+}
+
+// Adresse d'un lien "hôte:port" (hôte IPv4 ou localhost)
+static bool validLinkAddress(const std::string& value)
+{
+    size_t colon = value.rfind(':');
+    size_t port;
+    return colon != std::string::npos && colon > 0 && parseCount(value.substr(colon + 1), 65535, port);
+}
+
+// Analyse les options de démarrage
+bool parseServerOptions(int argc, char** argv, int first, ServerConfig& config, std::string& error)
+{
+    for (int i = first; i < argc; ++i)
+    {
+        std::string name;
+        std::string value;
+        if (!splitOption(argv[i], name, value))
+        {
+            error = std::string("Invalid option format: ") + argv[i];
+            return false;
+        }
+
+        if (name == "backend")
+        {
+            if (!Poller::isSupported(value))
+            {
+                error = "Unsupported backend: " + value;
+                return false;
+            }
+            config.backend = value;
+        }
+        else if (name == "threads")
+        {
+            if (!parseCount(value, MAX_THREADS, config.threads))
+            {
+                error = "Invalid thread count: " + value;
+                return false;
+            }
+        }
+        else if (name == "backlog")
+        {
+            size_t backlog;
+            if (!parseCount(value, 65535, backlog))
+            {
+                error = "Invalid backlog: " + value;
+                return false;
+            }
+            config.backlog = (int)backlog;
+        }
+        else if (name == "accept-budget")
+        {
+            if (!parseCount(value, 100000, config.acceptBudget))
+            {
+                error = "Invalid accept budget: " + value;
+                return false;
+            }
+        }
+        else if (name == "flood-rate")
+        {
+            if (value == "0")
+                config.floodRate = 0;
+            else if (!parseCount(value, 1000, config.floodRate))
+            {
+                error = "Invalid flood rate: " + value;
+                return false;
+            }
+        }
+        else if (name == "flood-burst")
+        {
+            if (!parseCount(value, 100000, config.floodBurst))
+            {
+                error = "Invalid flood burst: " + value;
+                return false;
+            }
+        }
+        else if (name == "registration-timeout")
+        {
+            if (!parseCount(value, 86400, config.registrationTimeout))
+            {
+                error = "Invalid registration timeout: " + value;
+                return false;
+            }
+        }
+        else if (name == "ping-interval")
+        {
+            if (!parseCount(value, 86400, config.pingInterval))
+            {
+                error = "Invalid ping interval: " + value;
+                return false;
+            }
+        }
+        else if (name == "ping-timeout")
+        {
+            if (!parseCount(value, 86400, config.pingTimeout))
+            {
+                error = "Invalid ping timeout: " + value;
+                return false;
+            }
+        }
+        else if (name == "idle-timeout")
+        {
+            if (value == "0")
+                config.idleTimeout = 0;
+            else if (!parseCount(value, 30 * 86400, config.idleTimeout))
+            {
+                error = "Invalid idle timeout: " + value;
+                return false;
+            }
+        }
+        else if (name == "log-level")
+        {
+            if (!Logger::parseLevel(value, config.logLevel))
+            {
+                error = "Invalid log level: " + value;
+                return false;
+            }
+        }
+        else if (name == "casemapping")
+        {
+            if (!CaseMap::parse(value, config.caseMapping))
+            {
+                error = "Invalid case mapping: " + value;
+                return false;
+            }
+        }
+        else if (name == "oper-name")
+        {
+            if (value.empty() || value.find_first_of(" :") != std::string::npos)
+            {
+                error = "Invalid operator name: " + value;
+                return false;
+            }
+            config.operName = value;
+        }
+        else if (name == "oper-password")
+        {
+            if (value.empty())
+            {
+                error = "Operator password cannot be empty";
+                return false;
+            }
+            config.operPassword = value;
+        }
+        else if (name == "metrics-port")
+        {
+            size_t port;
+            if (!parseCount(value, 65535, port))
+            {
+                error = "Invalid metrics port: " + value;
+                return false;
+            }
+            config.metricsPort = (int)port;
+        }
+        else if (name == "server-name")
+        {
+            if (!validServerName(value))
+            {
+                error = "Invalid server name: " + value;
+                return false;
+            }
+            config.serverName = value;
+        }
+        else if (name == "link-password")
+        {
+            if (value.empty())
+            {
+                error = "Link password cannot be empty";
+                return false;
+            }
+            config.linkPassword = value;
+        }
+        else if (name == "link")
+        {
+            if (!validLinkAddress(value))
+            {
+                error = "Invalid link address: " + value;
+                return false;
+            }
+            config.links.push_back(value);
+        }
+        else
+        {
+            error = "Unknown option: --" + name;
+            return false;
+        }
+    }
+
+    // Un lien sortant s'annonce avec le mot de passe des liens
+    if (!config.links.empty() && config.linkPassword.empty())
+    {
+        error = "--link needs --link-password";
+        return false;
+    }
+    return true;
+}
+
+// Affiche l'aide des options
+void printServerOptions(const char* program)
+{
+    std::cerr << "Usage: " << program << " <port> <password> [options]" << std::endl;
+    std::cerr << "Example: " << program << " 6667 mypassword" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --backend=poll|epoll   Socket readiness backend (default: poll)" << std::endl;
+    std::cerr << "  --threads=N            Event loops, one per thread (default: 1)" << std::endl;
+    std::cerr << "  --backlog=N            Pending connection queue (default: SOMAXCONN)" << std::endl;
+    std::cerr << "  --accept-budget=N      Connections accepted per loop wakeup (default: 64)" << std::endl;
+    std::cerr << "  --flood-rate=N         Lines per second per client, 0 = unlimited (default: 100)" << std::endl;
+    std::cerr << "  --flood-burst=N        Lines a client may send at once (default: 200)" << std::endl;
+    std::cerr << "  --registration-timeout=S  Seconds to complete PASS/NICK/USER (default: 30)" << std::endl;
+    std::cerr << "  --ping-interval=S      Seconds of silence before the server sends PING (default: 120)" << std::endl;
+    std::cerr << "  --ping-timeout=S       Seconds to answer a PING (default: 60)" << std::endl;
+    std::cerr << "  --idle-timeout=S       Seconds without a command before disconnection, 0 = never (default: 0)" << std::endl;
+    std::cerr << "  --log-level=LEVEL      debug|info|warn|error|off (default: info)" << std::endl;
+    std::cerr << "  --casemapping=MAPPING  rfc1459|ascii, for nickname and channel comparisons (default: rfc1459)" << std::endl;
+    std::cerr << "  --oper-name=NAME       Name expected by OPER (default: oper)" << std::endl;
+    std::cerr << "  --oper-password=PASS   Enable OPER <name> <pass> (needed for STATS)" << std::endl;
+    std::cerr << "  --metrics-port=PORT    Serve metrics as text on 127.0.0.1:PORT" << std::endl;
+    std::cerr << "  --server-name=NAME     Name in replies and between linked servers (default: ft_irc)" << std::endl;
+    std::cerr << "  --link-password=PASS   Accept server links (PASS <pass> TS 6) on the client port" << std::endl;
+    std::cerr << "  --link=HOST:PORT       Link to another server at startup, retried until up (repeatable)" << std::endl;
+}
@@ -0,0 +1,114 @@
+#include "EpollPoller.hpp"
+
+#ifdef __linux__
+
+#include <unistd.h>  // Pour close()
+#include <cstring>   // Pour memset()
+
+// Constructeur : crée l'instance epoll
+EpollPoller::EpollPoller() : _epoll_fd(epoll_create1(EPOLL_CLOEXEC)), _ready(64), _watched(0)
+{
+}
+
+// Destructeur : ferme l'instance epoll
+EpollPoller::~EpollPoller()
+{
+    if (_epoll_fd >= 0)
+        close(_epoll_fd);
+}
+
+// Retourne true si l'instance epoll est utilisable
+bool EpollPoller::isValid() const
+{
+    return _epoll_fd >= 0;
+}
+
+// Enregistre un fd auprès du noyau (lecture seulement)
+bool EpollPoller::add(int fd)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        return false;
+    if ((size_t)fd >= _interests.size())
+        _interests.resize(fd + 1, 0);
+    _interests[fd] = EPOLLIN;
+    ++_watched;
+    return true;
+}
+
+// Met à jour le masque mémorisé puis celui du noyau
+bool EpollPoller::modify(int fd, uint32_t interest)
+{
+    if (fd < 0 || (size_t)fd >= _interests.size())
+        return false;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = interest;
+    ev.data.fd = fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &ev) < 0)
+        return false;
+    _interests[fd] = interest;
+    return true;
+}
+
+// Active ou désactive EPOLLOUT pour un fd
+bool EpollPoller::setWriteInterest(int fd, bool enabled)
+{
+    if (fd < 0 || (size_t)fd >= _interests.size())
+        return false;
+    return modify(fd, enabled ? (_interests[fd] | EPOLLOUT) : (_interests[fd] & ~EPOLLOUT));
+}
+
+// Active ou désactive EPOLLIN pour un fd
+bool EpollPoller::setReadInterest(int fd, bool enabled)
+{
+    if (fd < 0 || (size_t)fd >= _interests.size())
+        return false;
+    return modify(fd, enabled ? (_interests[fd] | EPOLLIN) : (_interests[fd] & ~EPOLLIN));
+}
+
+// Retire un fd de l'instance epoll
+void EpollPoller::remove(int fd)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, &ev) == 0 && _watched > 0)
+        --_watched;
+}
+
+// Appelle epoll_wait() : seuls les sockets actifs sont retournés
+int EpollPoller::wait(int timeout_ms)
+{
+    _events.clear();
+
+    // Agrandir le tampon si le précédent appel l'a rempli entièrement
+    if (_ready.size() < _watched && _ready.size() < 4096)
+        _ready.resize(_ready.size() * 2);
+
+    int count = epoll_wait(_epoll_fd, &_ready[0], _ready.size(), timeout_ms);
+    if (count <= 0)
+        return count;
+
+    for (int i = 0; i < count; ++i)
+    {
+        PollerEvent event;
+        event.fd = _ready[i].data.fd;
+        // EPOLLHUP/EPOLLERR sont remontés comme lisibles : recv() signalera la fermeture
+        event.readable = (_ready[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0;
+        event.writable = (_ready[i].events & EPOLLOUT) != 0;
+        _events.push_back(event);
+    }
+    return count;
+}
+
+// Nom du backend
+const char* EpollPoller::name() const
+{
+    return "epoll";
+}
+
+#endif
@@ -0,0 +1,413 @@
+#include "EventLoop.hpp"
+#include "Server.hpp"
+#include "Client.hpp"
+#include "Poller.hpp"
+#include "utils.hpp"
+#include <unistd.h>  // Pour pipe(), read(), write(), close()
+#include <csignal>   // Pour sigset_t, pthread_sigmask()
+#include <climits>   // Pour ULONG_MAX
+
+// Suspension de l'écoute quand le processus n'a plus de descripteur (doublée jusqu'au plafond)
+static const unsigned long ACCEPT_PAUSE_MIN_MS = 50;
+static const unsigned long ACCEPT_PAUSE_MAX_MS = 2000;
+
+// Boucle exécutée par le thread courant
+static __thread EventLoop* t_currentLoop = NULL;
+
+LoopStats::LoopStats()
+    : accepted(0), closed(0), bytesIn(0), bytesOut(0), shortWrites(0), writes(0), messagesIn(0), messagesOut(0),
+      floodDeferrals(0), readPauses(0), pingsSent(0), timeouts(0), allocs(0), allocBytes(0)
+{
+}
+
+// Constructeur : la boucle n'est utilisable qu'après init()
+EventLoop::EventLoop(Server* server, size_t id, size_t loopCount)
+    : _server(server), _id(id), _listen_fd(-1), _poller(NULL), _threadStarted(false), _clientCount(0), _resumeAt(ULONG_MAX),
+      _acceptResumeAt(ULONG_MAX), _acceptBackoff(ACCEPT_PAUSE_MIN_MS),
+      _timers(monotonic_ms()),
+      _outbox(loopCount), _outboxTargets(loopCount, static_cast<EventLoop*>(NULL))
+{
+    _wake_pipe[0] = -1;
+    _wake_pipe[1] = -1;
+}
+
+// Destructeur : ferme le pipe, le socket d'écoute et le backend
+EventLoop::~EventLoop()
+{
+    destroyAllClients();
+    if (_wake_pipe[0] >= 0)
+        close(_wake_pipe[0]);
+    if (_wake_pipe[1] >= 0)
+        close(_wake_pipe[1]);
+    if (_listen_fd >= 0)
+        close(_listen_fd);
+    delete _poller;
+}
+
+// Crée le backend de surveillance et le pipe de réveil
+bool EventLoop::init(const std::string& backend)
+{
+    _poller = Poller::create(backend);
+    if (!_poller)
+        return false;
+
+    if (pipe(_wake_pipe) < 0)
+        return false;
+    if (!set_nonblocking(_wake_pipe[0]) || !set_nonblocking(_wake_pipe[1]))
+        return false;
+
+    return _poller->add(_wake_pipe[0]);
+}
+
+// --- Accesseurs ---
+
+size_t EventLoop::getId() const
+{
+    return _id;
+}
+
+Server* EventLoop::getServer() const
+{
+    return _server;
+}
+
+Poller* EventLoop::getPoller() const
+{
+    return _poller;
+}
+
+int EventLoop::getListenFd() const
+{
+    return _listen_fd;
+}
+
+void EventLoop::setListenFd(int fd)
+{
+    _listen_fd = fd;
+}
+
+int EventLoop::getWakeFd() const
+{
+    return _wake_pipe[0];
+}
+
+// --- Table des clients ---
+
+// Crée un client dans le pool et l'enregistre à l'indice de son fd
+Client* EventLoop::createClient(int fd)
+{
+    if ((size_t)fd >= _clients.size())
+    {
+        size_t size = _clients.empty() ? 64 : _clients.size();
+        while (size <= (size_t)fd)
+            size *= 2;
+        _clients.resize(size, NULL);
+    }
+
+    Client* client = new (_clientPool.allocate()) Client(fd, this);
+    _clients[fd] = client;
+    ++_clientCount;
+    return client;
+}
+
+// Retourne le client de la boucle associé à ce fd (NULL si aucun)
+Client* EventLoop::findClient(int fd) const
+{
+    if (fd < 0 || (size_t)fd >= _clients.size())
+        return NULL;
+    return _clients[fd];
+}
+
+// Retire le client de la table et rend son emplacement au pool
+void EventLoop::destroyClient(Client* client)
+{
+    int fd = client->getFd();
+    if (fd >= 0 && (size_t)fd < _clients.size() && _clients[fd] == client)
+    {
+        _clients[fd] = NULL;
+        --_clientCount;
+    }
+    _timers.cancel(client->getTimer());
+    _clientPool.destroy(client);
+}
+
+size_t EventLoop::getClientCount() const
+{
+    return _clientCount;
+}
+
+void EventLoop::destroyAllClients()
+{
+    for (size_t fd = 0; fd < _clients.size(); ++fd)
+    {
+        if (!_clients[fd])
+            continue;
+        close(fd);
+        _timers.cancel(_clients[fd]->getTimer());
+        _clientPool.destroy(_clients[fd]);
+        _clients[fd] = NULL;
+    }
+    _clientCount = 0;
+}
+
+LoopStats& EventLoop::getStats()
+{
+    return _stats;
+}
+
+// Publie les compteurs du tour (thread de la boucle)
+void EventLoop::publishStats()
+{
+    ScopedLock lock(_statsLock);
+    _published = _stats;
+}
+
+// Derniers compteurs publiés (n'importe quel thread)
+LoopStats EventLoop::getPublishedStats()
+{
+    ScopedLock lock(_statsLock);
+    return _published;
+}
+
+// --- Envoi groupé ---
+
+// Un client n'est inscrit qu'une fois par tour, quel que soit le nombre de messages reçus
+void EventLoop::scheduleFlush(Client* client)
+{
+    client->setFlushPending(true);
+    _flushQueue.push_back(client->getFd());
+}
+
+// Les erreurs d'envoi marquent le client (isClosing) : sa déconnexion passe par POLLOUT
+void EventLoop::flushClients()
+{
+    for (size_t i = 0; i < _flushQueue.size(); ++i)
+    {
+        // Le fd a pu être fermé puis réattribué : seul un client encore inscrit est envoyé
+        Client* client = findClient(_flushQueue[i]);
+        if (!client || !client->isFlushPending())
+            continue;
+        client->setFlushPending(false);
+        client->flushOutput();
+    }
+    _flushQueue.clear();
+}
+
+// --- Contrôle de flux ---
+
+// Un client n'est inscrit qu'une fois ; la reprise suit le plus proche des instants demandés
+void EventLoop::defer(Client* client, unsigned long when)
+{
+    if (!client->isDeferred())
+    {
+        client->setDeferred(true);
+        _deferred.push_back(client->getFd());
+    }
+    if (when < _resumeAt)
+        _resumeAt = when;
+}
+
+// Temps restant avant la reprise (0 si elle est déjà due)
+int EventLoop::resumeTimeout(unsigned long now) const
+{
+    if (_deferred.empty())
+        return -1;
+    if (_resumeAt <= now)
+        return 0;
+    unsigned long delay = _resumeAt - now;
+    return delay > INT_MAX ? INT_MAX : (int)delay;
+}
+
+TimerWheel& EventLoop::getTimers()
+{
+    return _timers;
+}
+
+// Le plus proche des délais (une valeur négative signifie "aucun")
+int EventLoop::nextTimeout(unsigned long now) const
+{
+    int resume = resumeTimeout(now);
+    int timer = _timers.timeout(now);
+    if (_acceptResumeAt != ULONG_MAX)
+    {
+        unsigned long delay = _acceptResumeAt > now ? _acceptResumeAt - now : 0;
+        int acceptDelay = delay > INT_MAX ? INT_MAX : (int)delay;
+        if (resume < 0 || acceptDelay < resume)
+            resume = acceptDelay;
+    }
+    if (resume < 0)
+        return timer;
+    if (timer < 0)
+        return resume;
+    return resume < timer ? resume : timer;
+}
+
+// Le socket d'écoute reste prêt tant que sa file n'est pas vidée : sans cette suspension,
+// un poller par niveau le signalerait à chaque tour et la boucle tournerait à vide
+unsigned long EventLoop::pauseAccept(unsigned long now)
+{
+    unsigned long delay = _acceptBackoff;
+    if (_acceptResumeAt == ULONG_MAX)
+        _poller->setReadInterest(_listen_fd, false);
+    _acceptResumeAt = now + delay;
+    _acceptBackoff = delay * 2 > ACCEPT_PAUSE_MAX_MS ? ACCEPT_PAUSE_MAX_MS : delay * 2;
+    return delay;
+}
+
+// Réactive l'écoute quand la suspension est échue
+void EventLoop::resumeAccept(unsigned long now)
+{
+    if (_acceptResumeAt > now)
+        return;
+    _poller->setReadInterest(_listen_fd, true);
+    _acceptResumeAt = ULONG_MAX;
+}
+
+// Une connexion a pu être acceptée : la prochaine suspension repart du délai minimal
+void EventLoop::resetAcceptBackoff()
+{
+    _acceptBackoff = ACCEPT_PAUSE_MIN_MS;
+}
+
+// Les clients repris qui ont encore des lignes en attente sont réinscrits par defer()
+bool EventLoop::takeDeferred(unsigned long now, std::vector<int>& fds)
+{
+    if (_deferred.empty() || _resumeAt > now)
+        return false;
+    fds.swap(_deferred);
+    _deferred.clear();
+    _resumeAt = ULONG_MAX;
+    return true;
+}
+
+// Retourne la boucle du thread courant
+EventLoop* EventLoop::current()
+{
+    return t_currentLoop;
+}
+
+// Associe une boucle au thread courant
+void EventLoop::setCurrent(EventLoop* loop)
+{
+    t_currentLoop = loop;
+}
+
+// --- Threads ---
+
+// Point d'entrée d'un thread secondaire : les signaux restent gérés par le thread principal
+void* EventLoop::threadMain(void* arg)
+{
+    EventLoop* loop = static_cast<EventLoop*>(arg);
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGQUIT);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    loop->_server->runLoop(*loop);
+    return NULL;
+}
+
+// Lance le thread de la boucle
+bool EventLoop::start()
+{
+    if (pthread_create(&_thread, NULL, &EventLoop::threadMain, this) != 0)
+        return false;
+    _threadStarted = true;
+    return true;
+}
+
+// Attend la fin du thread de la boucle
+void EventLoop::join()
+{
+    if (_threadStarted)
+    {
+        pthread_join(_thread, NULL);
+        _threadStarted = false;
+    }
+}
+
+// --- Réveil ---
+
+// Écrit un octet dans le pipe : la boucle sort de wait()
+void EventLoop::wake()
+{
+    char byte = 1;
+    ssize_t ret = write(_wake_pipe[1], &byte, 1);
+    (void)ret;  // Pipe plein : la boucle a déjà un réveil en attente
+}
+
+// Vide le pipe de réveil
+void EventLoop::consumeWake()
+{
+    char buffer[64];
+    while (read(_wake_pipe[0], buffer, sizeof(buffer)) > 0)
+        ;
+}
+
+// --- Messages entre boucles ---
+
+// Range le message dans la file de la boucle destinataire (aucun verrou : propre au thread courant)
+void EventLoop::stage(Client* client, const MessageRef& message)
+{
+    EventLoop* target = client->getLoop();
+    Delivery delivery;
+    delivery.client = client;
+    delivery.message = message;
+    _outbox[target->_id].push_back(delivery);
+    _outboxTargets[target->_id] = target;
+}
+
+// Poste les messages préparés : un verrou et au plus un réveil par boucle destinataire
+void EventLoop::flushOutbox()
+{
+    for (size_t i = 0; i < _outbox.size(); ++i)
+    {
+        if (_outbox[i].empty())
+            continue;
+
+        EventLoop* target = _outboxTargets[i];
+        bool wasEmpty;
+        {
+            ScopedLock lock(target->_mailboxLock);
+            wasEmpty = target->_mailbox.empty();
+            target->_mailbox.insert(target->_mailbox.end(), _outbox[i].begin(), _outbox[i].end());
+        }
+        _outbox[i].clear();
+
+        if (wasEmpty)
+            target->wake();
+    }
+}
+
+// Remet les messages postés par les autres boucles aux clients de cette boucle
+void EventLoop::drainMailbox()
+{
+    {
+        ScopedLock lock(_mailboxLock);
+        _draining.swap(_mailbox);
+    }
+
+    // Les clients sont vivants : seule cette boucle les détruit, après discardMailbox()
+    for (size_t i = 0; i < _draining.size(); ++i)
+        _draining[i].client->deliver(_draining[i].message);
+    _draining.clear();
+}
+
+// Retire les messages en attente pour un client détruit par cette boucle (l'ordre des autres est conservé)
+void EventLoop::discardMailbox(Client* client)
+{
+    ScopedLock lock(_mailboxLock);
+    size_t kept = 0;
+    for (size_t i = 0; i < _mailbox.size(); ++i)
+    {
+        if (_mailbox[i].client == client)
+            continue;
+        if (kept != i)
+            _mailbox[kept] = _mailbox[i];
+        ++kept;
+    }
+    _mailbox.resize(kept);
+}
@@ -0,0 +1,100 @@
+#include "IrcMessage.hpp"
+
+// Vue vide retournée pour un paramètre absent
+static const StringRef g_emptyParam;
+
+// Constructeur : message vide
+IrcMessage::IrcMessage() : paramCount(0), hasTrailing(false)
+{
+}
+
+// Retourne le i-ème paramètre (vue vide s'il n'existe pas)
+const StringRef& IrcMessage::param(size_t i) const
+{
+    return i < paramCount ? params[i] : g_emptyParam;
+}
+
+// Avance jusqu'au prochain caractère qui n'est pas un espace
+static size_t skipSpaces(const char* line, size_t length, size_t pos)
+{
+    while (pos < length && line[pos] == ' ')
+        ++pos;
+    return pos;
+}
+
+// Avance jusqu'au prochain espace
+static size_t skipWord(const char* line, size_t length, size_t pos)
+{
+    while (pos < length && line[pos] != ' ')
+        ++pos;
+    return pos;
+}
+
+// Découpe la ligne en tags, préfixe, commande et paramètres en une seule passe
+bool parseIrcMessage(const char* line, size_t length, IrcMessage& message)
+{
+    message.tags = StringRef();
+    message.prefix = StringRef();
+    message.command = StringRef();
+    message.paramCount = 0;
+    message.hasTrailing = false;
+
+    size_t pos = skipSpaces(line, length, 0);
+
+    // Tags IRCv3 : @clé=valeur;clé2
+    if (pos < length && line[pos] == '@')
+    {
+        size_t end = skipWord(line, length, pos);
+        message.tags = StringRef(line + pos + 1, end - pos - 1);
+        pos = skipSpaces(line, length, end);
+    }
+
+    // Préfixe : :nick!user@host ou :serveur
+    if (pos < length && line[pos] == ':')
+    {
+        size_t end = skipWord(line, length, pos);
+        message.prefix = StringRef(line + pos + 1, end - pos - 1);
+        pos = skipSpaces(line, length, end);
+    }
+
+    // Commande
+    size_t end = skipWord(line, length, pos);
+    if (end == pos)
+        return false;
+    message.command = StringRef(line + pos, end - pos);
+    pos = skipSpaces(line, length, end);
+
+    // Paramètres : le trailing (':') ou le 15e paramètre prend tout le reste de la ligne
+    while (pos < length && message.paramCount < IrcMessage::MAX_PARAMS)
+    {
+        if (line[pos] == ':' || message.paramCount == IrcMessage::MAX_PARAMS - 1)
+        {
+            if (line[pos] == ':')
+            {
+                ++pos;
+                message.hasTrailing = true;
+            }
+            message.params[message.paramCount++] = StringRef(line + pos, length - pos);
+            break;
+        }
+
+        end = skipWord(line, length, pos);
+        message.params[message.paramCount++] = StringRef(line + pos, end - pos);
+        pos = skipSpaces(line, length, end);
+    }
+    return true;
+}
+
+// Extrait l'élément jusqu'à la prochaine virgule (les éléments vides gardent leur position)
+bool nextListItem(const StringRef& list, size_t& pos, StringRef& item)
+{
+    if (pos > list.length)
+        return false;
+
+    size_t end = pos;
+    while (end < list.length && list.data[end] != ',')
+        ++end;
+    item = StringRef(list.data + pos, end - pos);
+    pos = end + 1;
+    return true;
+}
@@ -0,0 +1,124 @@
+#include "LineBuffer.hpp"
+#include <cstring>  // Pour memchr(), memmove()
+
+// Constructeur : la mémoire n'est allouée qu'à la première réception
+LineBuffer::LineBuffer() : _start(0), _end(0), _scan(0), _discarding(false), _overflowed(false)
+{
+}
+
+// Prépare la zone d'écriture pour recv()
+char* LineBuffer::writableSpace(size_t& available)
+{
+    if (_data.empty())
+        _data.resize(INITIAL_CAPACITY);
+
+    if (_end == _data.size())
+    {
+        if (_start > 0)
+        {
+            // Ramener les octets non consommés au début (les seuls à être déplacés)
+            memmove(&_data[0], &_data[_start], _end - _start);
+            _end -= _start;
+            _scan -= _start;
+            _start = 0;
+        }
+        else if (_data.size() < MAX_CAPACITY)
+        {
+            _data.resize(_data.size() * 2);
+        }
+        else if (_scan == _end)
+        {
+            // Buffer plein sans aucun '\n' : la ligne dépasse la limite, on l'abandonne
+            _start = 0;
+            _end = 0;
+            _scan = 0;
+            _discarding = true;
+            _overflowed = true;
+        }
+    }
+
+    available = _data.size() - _end;
+    return &_data[_end];
+}
+
+// Valide les octets reçus
+void LineBuffer::commit(size_t count)
+{
+    _end += count;
+}
+
+// Découpe la prochaine ligne sur place
+bool LineBuffer::nextLine(const char*& line, size_t& length)
+{
+    while (_scan < _end)
+    {
+        const char* base = &_data[0];
+        const char* newline = static_cast<const char*>(memchr(base + _scan, '\n', _end - _scan));
+        if (!newline)
+        {
+            _scan = _end;
+            break;
+        }
+
+        size_t pos = newline - base;
+        if (_discarding)
+        {
+            // Fin de la ligne trop longue : on reprend à la ligne suivante
+            _discarding = false;
+            _start = pos + 1;
+            _scan = pos + 1;
+            continue;
+        }
+
+        line = base + _start;
+        length = pos - _start;
+        if (length > 0 && line[length - 1] == '\r')
+            --length;
+
+        _start = pos + 1;
+        _scan = pos + 1;
+        return true;
+    }
+
+    // Tout est consommé (ou appartient à une ligne abandonnée) : repartir du début sans rien déplacer
+    if (_start == _end || _discarding)
+    {
+        _start = 0;
+        _end = 0;
+        _scan = 0;
+    }
+    return false;
+}
+
+// Cherche un '\n' au-delà de la zone déjà parcourue, sans avancer le début des données
+bool LineBuffer::hasLine()
+{
+    if (_scan >= _end)
+        return false;
+    if (!memchr(&_data[0] + _scan, '\n', _end - _scan))
+    {
+        _scan = _end;
+        return false;
+    }
+    return true;
+}
+
+// Buffer à sa taille maximale, entièrement occupé par des données non consommées
+bool LineBuffer::full() const
+{
+    return _data.size() >= MAX_CAPACITY && _start == 0 && _end == _data.size();
+}
+
+// Nombre d'octets non consommés
+size_t LineBuffer::pending() const
+{
+    return _end - _start;
+}
+
+// Signale une fois l'abandon d'une ligne trop longue
+bool LineBuffer::takeOverflow()
+{
+    bool overflowed = _overflowed;
+    _overflowed = false;
+    return overflowed;
+}
@@ -0,0 +1,388 @@
+#include "Logger.hpp"
+#include <pthread.h>     // Pour pthread_create(), pthread_join()
+#include <sys/time.h>    // Pour gettimeofday()
+#include <unistd.h>      // Pour write()
+#include <cstring>       // Pour std::memcpy(), std::strlen()
+#include <cerrno>        // Pour errno
+#include <ctime>         // Pour localtime_r(), nanosleep()
+#include <csignal>       // Pour sigset_t, pthread_sigmask()
+#include <cstdio>        // Pour snprintf()
+
+// Nombre de cases de l'anneau (puissance de 2)
+static const size_t RING_SIZE = 4096;
+
+// Taille des lots écrits par le thread d'arrière-plan
+static const size_t BATCH_SIZE = 64 * 1024;
+
+// Case de l'anneau : le numéro de séquence indique si elle est libre ou remplie
+// (file bornée multi-producteurs : seq == pos libre, seq == pos + 1 remplie)
+struct LogSlot {
+    volatile size_t seq;
+    LogLevel level;
+    long seconds;
+    long micros;
+    size_t length;
+    char text[Logger::LINE_SIZE];
+};
+
+// État partagé du journal
+struct LogRing {
+    LogSlot slots[RING_SIZE];
+    volatile size_t enqueuePos;         // Prochaine case à réserver (producteurs, CAS)
+    size_t dequeuePos;                  // Prochaine case à lire (thread d'écriture seul)
+    volatile unsigned long logged;      // Lignes déposées
+    volatile unsigned long dropped;     // Lignes perdues (anneau plein)
+    volatile int level;                 // Niveau minimal
+    volatile bool stopping;             // Demande d'arrêt du thread
+    bool running;                       // Thread lancé ?
+    pthread_t thread;
+
+    LogRing() : enqueuePos(0), dequeuePos(0), logged(0), dropped(0), level(LOG_INFO), stopping(false), running(false)
+    {
+        for (size_t i = 0; i < RING_SIZE; ++i)
+            slots[i].seq = i;
+    }
+};
+
+static LogRing g_ring;
+
+static const char* levelName(LogLevel level)
+{
+    switch (level)
+    {
+        case LOG_DEBUG: return "DEBUG";
+        case LOG_INFO:  return "INFO ";
+        case LOG_WARN:  return "WARN ";
+        case LOG_ERROR: return "ERROR";
+        default:        return "     ";
+    }
+}
+
+// --- Écriture (thread d'arrière-plan) ---
+
+// Tampon de sortie d'un file descriptor, vidé par write() quand il est plein
+struct OutputBatch {
+    int fd;
+    size_t length;
+    char data[BATCH_SIZE];
+
+    explicit OutputBatch(int target) : fd(target), length(0) {}
+
+    void flush()
+    {
+        size_t offset = 0;
+        while (offset < length)
+        {
+            ssize_t written = ::write(fd, data + offset, length - offset);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                break;  // Sortie fermée : on abandonne ce lot
+            offset += written;
+        }
+        length = 0;
+    }
+
+    void append(const char* text, size_t size)
+    {
+        if (length + size > BATCH_SIZE)
+            flush();
+        std::memcpy(data + length, text, size);
+        length += size;
+    }
+};
+
+// Horodatage "HH:MM:SS" recalculé seulement quand la seconde change
+static void appendTimestamp(OutputBatch& out, long seconds, long micros)
+{
+    static long cachedSecond = -1;
+    static char cached[9];
+
+    if (seconds != cachedSecond)
+    {
+        time_t t = seconds;
+        struct tm parts;
+        localtime_r(&t, &parts);
+        strftime(cached, sizeof(cached), "%H:%M:%S", &parts);
+        cachedSecond = seconds;
+    }
+
+    char stamp[16];
+    std::memcpy(stamp, cached, 8);
+    stamp[8] = '.';
+    stamp[9] = '0' + (micros / 100000) % 10;
+    stamp[10] = '0' + (micros / 10000) % 10;
+    stamp[11] = '0' + (micros / 1000) % 10;
+    stamp[12] = ' ';
+    out.append(stamp, 13);
+}
+
+static void appendLine(OutputBatch& out, LogLevel level, long seconds, long micros, const char* text, size_t length)
+{
+    appendTimestamp(out, seconds, micros);
+    out.append(levelName(level), 5);
+    out.append(" ", 1);
+    out.append(text, length);
+    out.append("\n", 1);
+}
+
+// Vide l'anneau dans les lots stdout/stderr ; retourne le nombre de lignes lues
+static size_t drainRing(OutputBatch& out, OutputBatch& err)
+{
+    size_t count = 0;
+
+    for (;;)
+    {
+        LogSlot& slot = g_ring.slots[g_ring.dequeuePos & (RING_SIZE - 1)];
+        size_t seq = slot.seq;
+        __sync_synchronize();
+        if (seq != g_ring.dequeuePos + 1)
+            break;  // Case pas encore remplie : anneau vide (ou producteur en cours)
+
+        OutputBatch& target = slot.level >= LOG_WARN ? err : out;
+        appendLine(target, slot.level, slot.seconds, slot.micros, slot.text, slot.length);
+
+        // Libère la case pour le tour suivant de l'anneau
+        __sync_synchronize();
+        slot.seq = g_ring.dequeuePos + RING_SIZE;
+        ++g_ring.dequeuePos;
+        ++count;
+    }
+    return count;
+}
+
+// Signale les lignes perdues depuis le dernier rapport
+static void reportDropped(OutputBatch& err, unsigned long& reported)
+{
+    unsigned long dropped = g_ring.dropped;
+    if (dropped == reported)
+        return;
+
+    char text[64];
+    int length = snprintf(text, sizeof(text), "[LOGGER] %lu lines dropped (ring full)", dropped - reported);
+    reported = dropped;
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    appendLine(err, LOG_WARN, now.tv_sec, now.tv_usec, text, length);
+}
+
+static void* logThread(void*)
+{
+    // Les signaux sont traités par le thread principal
+    sigset_t blocked;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    sigaddset(&blocked, SIGQUIT);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
+
+    static OutputBatch out(1);
+    static OutputBatch err(2);
+    unsigned long reported = 0;
+
+    for (;;)
+    {
+        bool stopping = g_ring.stopping;
+        size_t count = drainRing(out, err);
+        reportDropped(err, reported);
+        out.flush();
+        err.flush();
+
+        if (count == 0)
+        {
+            if (stopping)
+                break;
+            // Anneau vide : courte pause plutôt qu'un réveil par les producteurs (qui ne bloquent jamais)
+            struct timespec pause = { 0, 2 * 1000 * 1000 };
+            nanosleep(&pause, NULL);
+        }
+    }
+    return NULL;
+}
+
+// --- Interface publique ---
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level)
+{
+    static const char* names[] = { "debug", "info", "warn", "error", "off" };
+    for (int i = LOG_DEBUG; i <= LOG_OFF; ++i)
+    {
+        if (name == names[i])
+        {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::setLevel(LogLevel level)
+{
+    g_ring.level = level;
+}
+
+LogLevel Logger::getLevel()
+{
+    return static_cast<LogLevel>(g_ring.level);
+}
+
+bool Logger::enabled(LogLevel level)
+{
+    return level >= g_ring.level && level != LOG_OFF;
+}
+
+bool Logger::start()
+{
+    if (g_ring.running)
+        return true;
+    g_ring.stopping = false;
+    if (pthread_create(&g_ring.thread, NULL, logThread, NULL) != 0)
+        return false;
+    g_ring.running = true;
+    return true;
+}
+
+void Logger::stop()
+{
+    if (!g_ring.running)
+        return;
+    g_ring.stopping = true;
+    pthread_join(g_ring.thread, NULL);
+    g_ring.running = false;
+}
+
+// Réserve une case par CAS sur enqueuePos ; anneau plein -> ligne perdue
+void Logger::write(LogLevel level, const char* text, size_t length)
+{
+    if (!enabled(level))
+        return;
+    if (length > LINE_SIZE)
+        length = LINE_SIZE;
+
+    LogSlot* slot;
+    size_t pos = g_ring.enqueuePos;
+    for (;;)
+    {
+        slot = &g_ring.slots[pos & (RING_SIZE - 1)];
+        size_t seq = slot->seq;
+        __sync_synchronize();
+        long diff = (long)seq - (long)pos;
+        if (diff == 0)
+        {
+            size_t previous = __sync_val_compare_and_swap(&g_ring.enqueuePos, pos, pos + 1);
+            if (previous == pos)
+                break;
+            pos = previous;  // Un autre producteur a pris la case
+        }
+        else if (diff < 0)
+        {
+            __sync_add_and_fetch(&g_ring.dropped, 1);
+            return;
+        }
+        else
+            pos = g_ring.enqueuePos;
+    }
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    slot->level = level;
+    slot->seconds = now.tv_sec;
+    slot->micros = now.tv_usec;
+    slot->length = length;
+    std::memcpy(slot->text, text, length);
+
+    // Publie la case au thread d'écriture
+    __sync_synchronize();
+    slot->seq = pos + 1;
+    __sync_add_and_fetch(&g_ring.logged, 1);
+}
+
+unsigned long Logger::logged()
+{
+    return g_ring.logged;
+}
+
+unsigned long Logger::dropped()
+{
+    return g_ring.dropped;
+}
+
+// --- LogLine ---
+
+LogLine::LogLine(LogLevel level) : _level(level), _enabled(Logger::enabled(level)), _length(0)
+{
+}
+
+LogLine::~LogLine()
+{
+    if (_enabled)
+        Logger::write(_level, _buffer, _length);
+}
+
+// Ajoute du texte (tronqué à LINE_SIZE ; les retours à la ligne deviennent des espaces)
+LogLine& LogLine::write(const char* text, size_t length)
+{
+    if (!_enabled)
+        return *this;
+    for (size_t i = 0; i < length && _length < Logger::LINE_SIZE; ++i)
+    {
+        char c = text[i];
+        _buffer[_length++] = (c == '\n' || c == '\r') ? ' ' : c;
+    }
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const std::string& text)
+{
+    return write(text.data(), text.size());
+}
+
+LogLine& LogLine::operator<<(const char* text)
+{
+    return _enabled ? write(text, std::strlen(text)) : *this;
+}
+
+LogLine& LogLine::operator<<(char c)
+{
+    return write(&c, 1);
+}
+
+LogLine& LogLine::appendNumber(unsigned long value, bool negative)
+{
+    if (!_enabled)
+        return *this;
+
+    char digits[24];
+    size_t count = 0;
+    do
+    {
+        digits[sizeof(digits) - 1 - count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    if (negative)
+        digits[sizeof(digits) - 1 - count++] = '-';
+    return write(digits + sizeof(digits) - count, count);
+}
+
+LogLine& LogLine::operator<<(int value)
+{
+    return *this << (long)value;
+}
+
+LogLine& LogLine::operator<<(unsigned int value)
+{
+    return appendNumber(value, false);
+}
+
+LogLine& LogLine::operator<<(long value)
+{
+    if (value < 0)
+        return appendNumber(-(unsigned long)value, true);
+    return appendNumber(value, false);
+}
+
+LogLine& LogLine::operator<<(unsigned long value)
+{
+    return appendNumber(value, false);
+}
@@ -0,0 +1,287 @@
+#include "MessageBuffer.hpp"
+#include "Mutex.hpp"
+
+// Réserve de buffers libres par thread : au plus POOL_SIZE buffers d'au plus POOL_CAPACITY octets
+// (les rares messages plus longs, comme les réponses de STATS, retournent au tas)
+static const size_t POOL_SIZE = 256;
+static const size_t POOL_CAPACITY = 1024;
+
+// Capacité d'un buffer neuf de la réserve : une ligne IRC complète (512 octets avec \r\n),
+// pour qu'un buffer réutilisé n'ait jamais à grandir quel que soit le message suivant
+static const size_t LINE_CAPACITY = 512;
+
+// Un message destiné à une autre boucle est libéré par celle-ci : les buffers migrent du thread
+// qui écrit vers ceux qui envoient. Les réserves s'équilibrent par lots de POOL_BATCH buffers
+// via une réserve commune (un verrou par lot, pas par message), limitée à SHARED_SIZE buffers
+static const size_t POOL_BATCH = POOL_SIZE / 2;
+static const size_t SHARED_SIZE = 16 * POOL_SIZE;
+
+static __thread MessageBuffer* t_pool = NULL;
+static __thread size_t t_poolSize = 0;
+
+static Mutex g_sharedLock;
+static MessageBuffer* g_shared = NULL;
+static size_t g_sharedSize = 0;
+
+// --- MessageBuffer ---
+
+// Constructeur : buffer vide rempli par un MessageBuilder
+MessageBuffer::MessageBuffer() : _refs(1), _next(NULL)
+{
+}
+
+// Constructeur : copie unique des octets du message
+MessageBuffer::MessageBuffer(const std::string& data) : _data(data), _refs(1), _next(NULL)
+{
+}
+
+// Destructeur
+MessageBuffer::~MessageBuffer()
+{
+}
+
+// Réutilise un buffer de la réserve (vidé à son retour, capacité intacte)
+// Réserve du thread vide : reprend un lot dans la réserve commune avant de passer par le tas
+MessageBuffer* MessageBuffer::acquire()
+{
+    if (!t_pool && g_sharedSize > 0)  // Lecture indicative sans verrou, revérifiée sous le verrou
+    {
+        ScopedLock lock(g_sharedLock);
+        while (g_shared && t_poolSize < POOL_BATCH)
+        {
+            MessageBuffer* buffer = g_shared;
+            g_shared = buffer->_next;
+            --g_sharedSize;
+            buffer->_next = t_pool;
+            t_pool = buffer;
+            ++t_poolSize;
+        }
+    }
+
+    MessageBuffer* buffer = t_pool;
+    if (!buffer)
+    {
+        buffer = new MessageBuffer();
+        buffer->_data.reserve(LINE_CAPACITY);
+        return buffer;
+    }
+
+    t_pool = buffer->_next;
+    --t_poolSize;
+    buffer->_next = NULL;
+    buffer->_refs = 1;
+    return buffer;
+}
+
+// Garde le buffer pour un prochain message du thread, sinon le libère
+// Réserve du thread pleine : un lot part dans la réserve commune pour les threads qui en manquent
+void MessageBuffer::recycle(MessageBuffer* buffer)
+{
+    if (buffer->_data.capacity() > POOL_CAPACITY)
+    {
+        delete buffer;
+        return;
+    }
+
+    if (t_poolSize >= POOL_SIZE)
+    {
+        // Détacher les POOL_BATCH premiers buffers de la réserve du thread
+        MessageBuffer* first = t_pool;
+        MessageBuffer* last = first;
+        for (size_t i = 1; i < POOL_BATCH; ++i)
+            last = last->_next;
+        t_pool = last->_next;
+        t_poolSize -= POOL_BATCH;
+
+        bool accepted = false;
+        {
+            ScopedLock lock(g_sharedLock);
+            if (g_sharedSize + POOL_BATCH <= SHARED_SIZE)
+            {
+                last->_next = g_shared;
+                g_shared = first;
+                g_sharedSize += POOL_BATCH;
+                accepted = true;
+            }
+        }
+
+        // Réserve commune pleine : le lot retourne au tas
+        if (!accepted)
+        {
+            last->_next = NULL;
+            while (first)
+            {
+                MessageBuffer* next = first->_next;
+                delete first;
+                first = next;
+            }
+        }
+    }
+
+    buffer->_data.clear();
+    buffer->_next = t_pool;
+    t_pool = buffer;
+    ++t_poolSize;
+}
+
+// Libère la réserve du thread et la réserve commune
+void MessageBuffer::releasePool()
+{
+    while (t_pool)
+    {
+        MessageBuffer* next = t_pool->_next;
+        delete t_pool;
+        t_pool = next;
+    }
+    t_poolSize = 0;
+
+    ScopedLock lock(g_sharedLock);
+    while (g_shared)
+    {
+        MessageBuffer* next = g_shared->_next;
+        delete g_shared;
+        g_shared = next;
+    }
+    g_sharedSize = 0;
+}
+
+// --- MessageRef ---
+
+// Référence vide
+MessageRef::MessageRef() : _buffer(NULL)
+{
+}
+
+// Crée le buffer partagé (première référence)
+MessageRef::MessageRef(const std::string& data) : _buffer(new MessageBuffer(data))
+{
+}
+
+// Adopte la référence unique d'un buffer construit
+MessageRef::MessageRef(MessageBuffer* buffer) : _buffer(buffer)
+{
+}
+
+// Copie : partage le même buffer
+MessageRef::MessageRef(const MessageRef& other) : _buffer(other._buffer)
+{
+    if (_buffer)
+        __sync_add_and_fetch(&_buffer->_refs, 1);
+}
+
+// Affectation : change de buffer partagé
+MessageRef& MessageRef::operator=(const MessageRef& other)
+{
+    if (_buffer != other._buffer)
+    {
+        if (other._buffer)
+            __sync_add_and_fetch(&other._buffer->_refs, 1);
+        release();
+        _buffer = other._buffer;
+    }
+    return *this;
+}
+
+// Destructeur : libère la référence
+MessageRef::~MessageRef()
+{
+    release();
+}
+
+// Décrémente le compteur et libère le buffer à la dernière référence
+void MessageRef::release()
+{
+    if (_buffer && __sync_sub_and_fetch(&_buffer->_refs, 1) == 0)
+        MessageBuffer::recycle(_buffer);
+    _buffer = NULL;
+}
+
+// Retourne les octets du message
+const char* MessageRef::data() const
+{
+    return _buffer ? _buffer->_data.data() : "";
+}
+
+// Retourne la taille du message
+size_t MessageRef::size() const
+{
+    return _buffer ? _buffer->_data.size() : 0;
+}
+
+// Retourne true si la référence ne pointe vers aucun message
+bool MessageRef::empty() const
+{
+    return size() == 0;
+}
+
+// --- MessageBuilder ---
+
+// Constructeur : prend un buffer en réserve et s'assure de la capacité prévue
+MessageBuilder::MessageBuilder(size_t reserve) : _buffer(MessageBuffer::acquire())
+{
+    if (_buffer->_data.capacity() < reserve)
+        _buffer->_data.reserve(reserve);
+}
+
+// Destructeur : rend un message jamais terminé
+MessageBuilder::~MessageBuilder()
+{
+    if (_buffer)
+        MessageBuffer::recycle(_buffer);
+}
+
+MessageBuilder& MessageBuilder::operator<<(const std::string& text)
+{
+    _buffer->_data.append(text);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::operator<<(const StringRef& text)
+{
+    _buffer->_data.append(text.data, text.length);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::operator<<(const char* text)
+{
+    _buffer->_data.append(text);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::operator<<(char c)
+{
+    _buffer->_data.push_back(c);
+    return *this;
+}
+
+// Écrit un nombre en décimal (sans passer par un flux)
+MessageBuilder& MessageBuilder::operator<<(unsigned long value)
+{
+    char digits[24];
+    size_t length = 0;
+    do
+    {
+        digits[sizeof(digits) - 1 - length++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    _buffer->_data.append(digits + sizeof(digits) - length, length);
+    return *this;
+}
+
+MessageBuilder& MessageBuilder::append(const char* data, size_t length)
+{
+    _buffer->_data.append(data, length);
+    return *this;
+}
+
+// Termine la ligne (format IRC : \r\n obligatoire) et cède le buffer
+MessageRef MessageBuilder::finish()
+{
+    std::string& data = _buffer->_data;
+    if (data.size() < 2 || data[data.size() - 2] != '\r' || data[data.size() - 1] != '\n')
+        data.append("\r\n", 2);
+
+    MessageBuffer* buffer = _buffer;
+    _buffer = NULL;
+    return MessageRef(buffer);
+}
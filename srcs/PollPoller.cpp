@@ -0,0 +1,106 @@
+#include "PollPoller.hpp"
+
+// Constructeur
+PollPoller::PollPoller()
+{
+}
+
+// Destructeur
+PollPoller::~PollPoller()
+{
+}
+
+// Ajoute un fd au tableau poll() et mémorise sa position
+bool PollPoller::add(int fd)
+{
+    if (fd < 0)
+        return false;
+    if ((size_t)fd >= _slots.size())
+        _slots.resize(fd + 1, -1);
+    if (_slots[fd] != -1)
+        return false;
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    _slots[fd] = _poll_fds.size();
+    _poll_fds.push_back(pfd);
+    return true;
+}
+
+// Active ou désactive POLLOUT pour un fd
+bool PollPoller::setWriteInterest(int fd, bool enabled)
+{
+    if (fd < 0 || (size_t)fd >= _slots.size() || _slots[fd] == -1)
+        return false;
+
+    struct pollfd& pfd = _poll_fds[_slots[fd]];
+    if (enabled)
+        pfd.events |= POLLOUT;
+    else
+        pfd.events &= ~POLLOUT;
+    return true;
+}
+
+// Active ou désactive POLLIN pour un fd
+bool PollPoller::setReadInterest(int fd, bool enabled)
+{
+    if (fd < 0 || (size_t)fd >= _slots.size() || _slots[fd] == -1)
+        return false;
+
+    struct pollfd& pfd = _poll_fds[_slots[fd]];
+    if (enabled)
+        pfd.events |= POLLIN;
+    else
+        pfd.events &= ~POLLIN;
+    return true;
+}
+
+// Retire un fd en O(1) : le dernier élément prend sa place
+void PollPoller::remove(int fd)
+{
+    if (fd < 0 || (size_t)fd >= _slots.size() || _slots[fd] == -1)
+        return;
+
+    int index = _slots[fd];
+    int last = _poll_fds.size() - 1;
+    if (index != last)
+    {
+        _poll_fds[index] = _poll_fds[last];
+        _slots[_poll_fds[index].fd] = index;
+    }
+    _poll_fds.pop_back();
+    _slots[fd] = -1;
+}
+
+// Appelle poll() puis collecte les fds ayant des revents
+int PollPoller::wait(int timeout_ms)
+{
+    _events.clear();
+
+    int count = poll(_poll_fds.empty() ? NULL : &_poll_fds[0], _poll_fds.size(), timeout_ms);
+    if (count <= 0)
+        return count;
+
+    for (size_t i = 0; i < _poll_fds.size() && (int)_events.size() < count; ++i)
+    {
+        short revents = _poll_fds[i].revents;
+        if (!revents)
+            continue;
+
+        PollerEvent event;
+        event.fd = _poll_fds[i].fd;
+        // POLLHUP/POLLERR sont remontés comme lisibles : recv() signalera la fermeture
+        event.readable = (revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+        event.writable = (revents & POLLOUT) != 0;
+        _events.push_back(event);
+    }
+    return _events.size();
+}
+
+// Nom du backend
+const char* PollPoller::name() const
+{
+    return "poll";
+}
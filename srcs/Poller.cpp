@@ -0,0 +1,46 @@
+#include "Poller.hpp"
+#include "PollPoller.hpp"
+#include "EpollPoller.hpp"
+
+// Destructeur virtuel de l'interface
+Poller::~Poller()
+{
+}
+
+// Retourne les événements prêts du dernier wait()
+const std::vector<PollerEvent>& Poller::events() const
+{
+    return _events;
+}
+
+// Retourne true si le backend demandé existe sur cette plateforme
+bool Poller::isSupported(const std::string& backend)
+{
+    if (backend == "poll")
+        return true;
+#ifdef __linux__
+    if (backend == "epoll")
+        return true;
+#endif
+    return false;
+}
+
+// Fabrique : instancie le backend choisi au démarrage
+Poller* Poller::create(const std::string& backend)
+{
+    if (backend == "poll")
+        return new PollPoller();
+#ifdef __linux__
+    if (backend == "epoll")
+    {
+        EpollPoller* poller = new EpollPoller();
+        if (!poller->isValid())
+        {
+            delete poller;
+            return NULL;
+        }
+        return poller;
+    }
+#endif
+    return NULL;
+}
@@ -1,21 +1,31 @@
 #include "Server.hpp"
+#include "EventLoop.hpp"
 #include "utils.hpp"
+#include "Logger.hpp"
+#include "AllocStats.hpp"
 #include <sys/socket.h>  // Pour socket(), bind(), listen(), accept(), send()
 #include <netinet/in.h>  // Pour struct sockaddr_in
 #include <arpa/inet.h>   // Pour inet_ntop()
 #include <unistd.h>      // Pour close()
 #include <cstring>       // Pour memset()
 #include <cerrno>        // Pour errno
-#include <iostream>      // Pour std::cout, std::cerr
+#include <sstream>       // Pour std::ostringstream
 
 // Constructeur : initialise le serveur avec un port et un mot de passe
-Server::Server(int port, const std::string& password)
-    : _server_fd(-1), _port(port), _password(password), _serverName("ft_irc"), _running(false)
+Server::Server(int port, const std::string& password, const ServerConfig& config)
+    : _port(port), _password(password), _serverName(config.serverName), _config(config), _clientCount(0),
+      _peakClients(0), _startTime(time(NULL)), _metrics_fd(-1), _running(false),
+      _floodCost(config.floodRate ? 1000 / config.floodRate : 0), _floodWindow(_floodCost * config.floodBurst),
+      _deliveryBatch(0), _remoteUsers(0)
 {
-    std::cout << "=== IRC Server Initializing ===" << std::endl;
-    std::cout << "Port: " << port << std::endl;
+    LogLine(LOG_INFO) << "=== IRC Server Initializing === port " << port << ", backend " << config.backend
+                      << ", " << (unsigned long)config.threads << " thread(s)";
+
+    initCommands();
 
     setupServer();
+
+    setupLinks();
 }
 
 // Destructeur : ferme tous les sockets proprement
@@ -24,27 +34,42 @@ Server::~Server()
     stop();
 }
 
-// Crée et configure le socket serveur
-void Server::setupServer()
+// Crée un socket d'écoute configuré (SO_REUSEPORT quand plusieurs boucles écoutent le même port)
+int Server::createListener(int port, bool loopbackOnly, bool reusePort, int backlog)
 {
     // 1. Créer le socket (endpoint de communication)
-    _server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (_server_fd < 0)
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0)
         error_exit("Failed to create socket");
 
     // 2. Permettre la réutilisation de l'adresse
     // Évite l'erreur "Address already in use" si on relance rapidement
     int opt = 1;
-    if (setsockopt(_server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
     {
-        close(_server_fd);
+        close(listen_fd);
         error_exit("setsockopt SO_REUSEADDR failed");
     }
 
+    // Chaque boucle a son propre socket d'écoute : le noyau répartit les connexions
+    if (reusePort)
+    {
+#ifdef SO_REUSEPORT
+        if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+        {
+            close(listen_fd);
+            error_exit("setsockopt SO_REUSEPORT failed");
+        }
+#else
+        close(listen_fd);
+        error_exit("SO_REUSEPORT is not available: use --threads=1");
+#endif
+    }
+
     // 3. Mettre le socket en mode non-bloquant
-    if (!set_nonblocking(_server_fd))
+    if (!set_nonblocking(listen_fd))
     {
-        close(_server_fd);
+        close(listen_fd);
         error_exit("Failed to set server socket to non-blocking");
     }
 
@@ -52,238 +77,585 @@ void Server::setupServer()
     struct sockaddr_in server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;           // IPv4
-    server_addr.sin_addr.s_addr = INADDR_ANY;   // Toutes les interfaces (0.0.0.0)
-    server_addr.sin_port = htons(_port);        // Port (conversion en network byte order)
+    server_addr.sin_addr.s_addr = loopbackOnly ? htonl(INADDR_LOOPBACK) : INADDR_ANY;  // 127.0.0.1 ou 0.0.0.0
+    server_addr.sin_port = htons(port);         // Port (conversion en network byte order)
 
     // 5. Associer le socket à l'adresse (bind)
-    if (bind(_server_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0)
+    if (bind(listen_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0)
     {
-        close(_server_fd);
+        close(listen_fd);
         error_exit("Bind failed - port may already be in use");
     }
 
     // 6. Mettre le socket en mode écoute
-    if (listen(_server_fd, 10) < 0)
+    // La file d'attente absorbe les rafales de reconnexion (plafonnée par net.core.somaxconn)
+    if (listen(listen_fd, backlog) < 0)
     {
-        close(_server_fd);
+        close(listen_fd);
         error_exit("Listen failed");
     }
 
-    // 7. Ajouter le socket serveur à la liste poll()
-    struct pollfd server_pollfd;
-    server_pollfd.fd = _server_fd;
-    server_pollfd.events = POLLIN;  // Surveiller les nouvelles connexions
-    server_pollfd.revents = 0;
-    _poll_fds.push_back(server_pollfd);
-
-    std::cout << "Server socket created and listening" << std::endl;
-    std::cout << "==================================" << std::endl;
+    return listen_fd;
 }
 
-// Accepte une nouvelle connexion client
-void Server::acceptNewClient()
+// Crée les boucles d'événements, chacune avec son backend et son socket d'écoute
+void Server::setupServer()
 {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-
-    // Accepter la connexion
-    int client_fd = accept(_server_fd, (struct sockaddr*)&client_addr, &client_len);
+    bool reusePort = _config.threads > 1;
 
-    if (client_fd < 0)
+    for (size_t i = 0; i < _config.threads; ++i)
     {
-        // En mode non-bloquant, EAGAIN = pas de connexion disponible (normal)
-        if (errno != EAGAIN && errno != EWOULDBLOCK)
-            std::cerr << "Accept error: " << strerror(errno) << std::endl;
-        return;
+        EventLoop* loop = new EventLoop(this, i, _config.threads);
+        _loops.push_back(loop);
+
+        if (!loop->init(_config.backend))
+            error_exit("Failed to initialize " + _config.backend + " event loop");
+
+        // Surveiller le socket d'écoute (nouvelles connexions)
+        loop->setListenFd(createListener(_port, false, reusePort, _config.backlog));
+        if (!loop->getPoller()->add(loop->getListenFd()))
+            error_exit("Failed to watch server socket");
     }
 
-    // Mettre le socket client en mode non-bloquant
-    if (!set_nonblocking(client_fd))
+    if (_config.metricsPort)
+        setupMetrics();
+
+    LogLine(LOG_INFO) << "Server socket created and listening";
+}
+
+// Accepte une connexion en attente, directement non bloquante
+// (accept4 sous Linux : un seul appel système au lieu de accept + deux fcntl)
+static int acceptNonBlocking(int listen_fd, struct sockaddr_in& client_addr)
+{
+    socklen_t client_len = sizeof(client_addr);
+#ifdef __linux__
+    return accept4(listen_fd, (struct sockaddr*)&client_addr, &client_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int client_fd = accept(listen_fd, (struct sockaddr*)&client_addr, &client_len);
+    if (client_fd >= 0 && !set_nonblocking(client_fd))
     {
-        std::cerr << "Failed to set client socket to non-blocking" << std::endl;
         close(client_fd);
-        return;
+        errno = EINVAL;
+        return -1;
     }
+    return client_fd;
+#endif
+}
 
-    // Créer l'objet Client sur le tas (allocation dynamique)
-    Client* new_client = new Client(client_fd);
+// Accepte les connexions en attente sur le socket d'écoute d'une boucle, jusqu'à EAGAIN
+// ou jusqu'au budget : le reste attend le prochain tour, pour ne pas affamer les clients existants
+void Server::acceptNewClients(EventLoop& loop)
+{
+    size_t accepted = 0;
+    bool paused = false;
+    unsigned long now = monotonic_ms();
 
-    // Stocker le client dans la map (fd -> Client*)
-    _clients[client_fd] = new_client;
+    while (accepted < _config.acceptBudget)
+    {
+        struct sockaddr_in client_addr;
+        int client_fd = acceptNonBlocking(loop.getListenFd(), client_addr);
 
-    // Ajouter le client à poll()
-    struct pollfd client_pollfd;
-    client_pollfd.fd = client_fd;
-    client_pollfd.events = POLLIN;  // Surveiller les données entrantes
-    client_pollfd.revents = 0;
-    _poll_fds.push_back(client_pollfd);
+        if (client_fd < 0)
+        {
+            // Connexion abandonnée par le client avant l'accept : on passe à la suivante
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            // Plus de descripteur libre : les connexions restent dans la file du noyau
+            // et l'écoute est suspendue au lieu d'être signalée prête à chaque tour
+            if (errno == EMFILE || errno == ENFILE)
+            {
+                unsigned long delay = loop.pauseAccept(now);
+                LogLine(LOG_WARN) << "Accept error: " << strerror(errno) << ", listening paused for "
+                                  << delay << " ms (loop " << (unsigned long)loop.getId() << ")";
+                paused = true;
+                break;
+            }
+            // En mode non-bloquant, EAGAIN = plus de connexion disponible (normal)
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                LogLine(LOG_ERROR) << "Accept error: " << strerror(errno);
+            break;
+        }
 
-    // Afficher des infos sur le nouveau client
-    char client_ip[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+        // Surveiller les données entrantes du client
+        if (!loop.getPoller()->add(client_fd))
+        {
+            LogLine(LOG_ERROR) << "Failed to watch client socket";
+            close(client_fd);
+            continue;
+        }
+
+        // Créer le Client dans le pool de la boucle, rangé à l'indice de son fd,
+        // avec son échéance d'enregistrement
+        Client* client = loop.createClient(client_fd);
+        client->markActivity(now);
+        client->markCommand(now);
+        loop.getTimers().schedule(client->getTimer(), now + _config.registrationTimeout * 1000);
+        ++loop.getStats().accepted;
+        ++accepted;
+
+        // Journaliser des infos sur le nouveau client
+        if (Logger::enabled(LOG_INFO))
+        {
+            char client_ip[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+            LogLine(LOG_INFO) << "[NEW CONNECTION] FD " << client_fd << " (loop " << (unsigned long)loop.getId()
+                              << ") from " << client_ip;
+        }
+    }
+
+    if (accepted == 0)
+        return;
+    if (!paused)
+        loop.resetAcceptBackoff();
 
-    std::cout << "\n[NEW CONNECTION]" << std::endl;
-    std::cout << "  FD: " << client_fd << std::endl;
-    std::cout << "  IP: " << client_ip << std::endl;
-    std::cout << "  Total clients: " << _clients.size() << std::endl;
+    // Un seul passage sous le verrou pour tout le lot
+    size_t total;
+    {
+        ScopedLock lock(_stateLock);
+        _clientCount += accepted;
+        total = _clientCount;
+        if (total > _peakClients)
+            _peakClients = total;
+    }
+    LogLine(LOG_INFO) << "[ACCEPT] Loop " << (unsigned long)loop.getId() << ": " << (unsigned long)accepted
+                      << " new connection(s), total clients: " << (unsigned long)total;
 }
 
-// Lit les données envoyées par un client
-void Server::readFromClient(int poll_index)
+// Lit les données envoyées par un client directement dans son buffer de réception
+void Server::readFromClient(EventLoop& loop, int client_fd)
 {
-    char buffer[512];
-    memset(buffer, 0, sizeof(buffer));
+    // Vérifier que le client existe dans la table de la boucle (accès direct par fd)
+    Client* client = loop.findClient(client_fd);
+    if (!client)
+        return;
+
+    LineBuffer& input = client->getRecvBuffer();
+
+    // Recevoir les données sans copie intermédiaire (hors verrou : le buffer appartient à la boucle)
+    size_t available;
+    char* dest = input.writableSpace(available);
 
-    int client_fd = _poll_fds[poll_index].fd;
-    
-    // Vérifier que le client existe dans la map
-    if (_clients.find(client_fd) == _clients.end())
+    // Lecture suspendue (buffer plein de lignes en attente) : seul POLLHUP/POLLERR réveille le socket
+    if (available == 0)
+    {
+        LogLine(LOG_INFO) << "[DISCONNECTION] FD " << client_fd << " (hang up while throttled)";
+        ScopedLock lock(_stateLock);
+        disconnectClient(client);
+        loop.flushOutbox();
         return;
-    
-    Client* client = _clients[client_fd];
+    }
 
-    // Recevoir les données
-    ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+    ssize_t bytes_read = recv(client_fd, dest, available, 0);
 
     if (bytes_read < 0)
     {
         if (errno != EAGAIN && errno != EWOULDBLOCK)
         {
-            std::cerr << "Recv error from FD " << client_fd << ": " << strerror(errno) << std::endl;
-            disconnectClient(poll_index);
+            LogLine(LOG_WARN) << "Recv error from FD " << client_fd << ": " << strerror(errno);
+            ScopedLock lock(_stateLock);
+            disconnectClient(client);
+            loop.flushOutbox();
         }
         return;
     }
 
+    // L'état partagé (channels, nicknames) n'est modifié que sous le verrou
+    ScopedLock lock(_stateLock);
+
     if (bytes_read == 0)
     {
-        std::cout << "\n[DISCONNECTION]" << std::endl;
-        std::cout << "  FD: " << client_fd << std::endl;
-        disconnectClient(poll_index);
+        LogLine(LOG_INFO) << "[DISCONNECTION] FD " << client_fd;
+        disconnectClient(client);
+        loop.flushOutbox();
         return;
     }
 
-    buffer[bytes_read] = '\0';
-    client->appendToBuffer(std::string(buffer));
+    input.commit(bytes_read);
+    loop.getStats().bytesIn += bytes_read;
+    client->markActivity(monotonic_ms());
 
-    std::cout << "\n[RECEIVED] FD " << client_fd << ": " << buffer;
+    (LogLine(LOG_DEBUG) << "[RECEIVED] FD " << client_fd << ": ").write(dest, bytes_read);
 
-    // Extraire et traiter les commandes complètes
-    std::string client_buffer = client->getBuffer();
-    size_t pos;
+    if (input.takeOverflow())
+        sendNumericReply(*client, "417", ":Input line was too long");
 
-    // Chercher les commandes terminées par \r\n ou \n
-    while ((pos = client_buffer.find('\n')) != std::string::npos)
-    {
-        std::string command = client_buffer.substr(0, pos);
+    processInput(loop, client);
 
-        if (!command.empty() && command[command.length() - 1] == '\r')
-            command = command.substr(0, command.length() - 1);
+    // Poster les messages destinés aux clients des autres boucles avant de relâcher le verrou
+    loop.flushOutbox();
+}
 
-        client_buffer = client_buffer.substr(pos + 1);
+// Extrait et traite les commandes complètes (\r\n ou \n), découpées sur place, au rythme permis
+void Server::processInput(EventLoop& loop, Client* client, bool resumed)
+{
+    LineBuffer& input = client->getRecvBuffer();
+    int client_fd = client->getFd();
+    unsigned long now = monotonic_ms();
+
+    const char* line;
+    size_t length;
+    while ((client->isServerLink() || client->canProcessLine(now, _floodWindow)) && input.nextLine(line, length))
+    {
+        if (length == 0)
+            continue;
 
-        if (!command.empty())
+        ++loop.getStats().messagesIn;
+
+        // Un lien serveur relaie le trafic de tout un côté du réseau : pas de contrôle de flux
+        if (client->isServerLink())
         {
-            processCommand(*client, command);
-            
-            // Si le client a été déconnecté (QUIT), on arrête ici
-            if (_clients.find(client_fd) == _clients.end())
+            processLinkMessage(*client, line, length);
+            if (loop.findClient(client_fd) != client)
                 return;
+            continue;
+        }
+
+        client->chargeLine(now, _floodCost);
+        processCommand(*client, line, length);
+
+        // Si le client a été déconnecté (QUIT), on arrête ici
+        if (loop.findClient(client_fd) != client)
+            return;
+    }
+
+    // Lignes en trop : elles attendent dans le buffer que l'horloge de pénalité le permette
+    bool waiting = input.hasLine();
+    if (waiting)
+    {
+        if (!client->isDeferred() && !resumed)
+        {
+            ++loop.getStats().floodDeferrals;
+            LogLine(LOG_DEBUG) << "[FLOOD] FD " << client_fd << " throttled, " << (unsigned long)input.pending()
+                               << " bytes pending";
         }
+        loop.defer(client, client->nextLineTime(_floodWindow));
     }
 
-    client->clearBuffer();
-    client->appendToBuffer(client_buffer);
+    // Buffer plein de lignes en attente : on cesse de lire le socket, et on ne reprend
+    // qu'une fois la moitié du buffer libérée (pas un appel système par ligne traitée)
+    if (waiting && input.full())
+    {
+        if (!client->isReadPaused())
+            ++loop.getStats().readPauses;
+        client->pauseReading(true);
+    }
+    else if (!waiting || input.pending() <= LineBuffer::MAX_CAPACITY / 2)
+        client->pauseReading(false);
 }
 
-// Déconnecte un client et le retire des listes
-void Server::disconnectClient(int poll_index)
+// Reprend les clients ralentis dont l'horloge de pénalité permet de nouveau de traiter des lignes
+void Server::resumeDeferred(EventLoop& loop, const std::vector<int>& fds)
 {
-    int client_fd = _poll_fds[poll_index].fd;
-    Client* client = _clients[client_fd];
+    ScopedLock lock(_stateLock);
+
+    for (size_t i = 0; i < fds.size(); ++i)
+    {
+        // Le fd a pu être fermé puis réattribué : seul un client encore inscrit est repris
+        Client* client = loop.findClient(fds[i]);
+        if (!client || !client->isDeferred())
+            continue;
+        client->setDeferred(false);
+        processInput(loop, client, true);
+    }
+
+    loop.flushOutbox();
+}
+
+// Envoie les données en attente d'un client quand son socket devient inscriptible
+void Server::writeToClient(EventLoop& loop, int client_fd)
+{
+    Client* client = loop.findClient(client_fd);
+    if (!client)
+        return;
+
+    // Erreur d'envoi ou SendQ dépassée : le client a demandé sa déconnexion
+    if (client->isClosing() || !client->flushOutput())
+    {
+        LogLine(LOG_INFO) << "[DISCONNECTION] FD " << client_fd << " (send queue error)";
+        ScopedLock lock(_stateLock);
+        disconnectClient(client);
+        loop.flushOutbox();
+    }
+}
+
+// Déconnecte un client et le retire des listes (verrou d'état pris, boucle propriétaire)
+void Server::disconnectClient(Client* client, const std::string& reason)
+{
+    EventLoop* loop = client->getLoop();
+    int client_fd = client->getFd();
+
+    // Lien serveur (ou sortant en cours) : netsplit de ce qui se trouvait derrière ; utilisateur : QUIT vers les pairs
+    if (client->isServerLink() || client->isOutboundLink())
+        dropLink(client, reason);
+    if (!client->isServerLink())
+        propagateQuit(*client, reason, NULL);
 
-    removeClientFromAllChannels(client);
+    removeClientFromAllChannels(client, reason);
+    unindexNickname(*client);
+
+    // Les messages postés par les autres boucles ne pourront plus être remis
+    loop->discardMailbox(client);
+
+    // Dernière tentative d'envoi des données en attente (ex: erreurs avant fermeture)
+    if (client->hasPendingOutput())
+        client->flushOutput();
+
+    unsigned long queued = client->getBytesQueued();
+    unsigned long flushed = client->getBytesFlushed();
+
+    loop->getPoller()->remove(client_fd);
     close(client_fd);
-    delete client;
-    _clients.erase(client_fd);
-    _poll_fds.erase(_poll_fds.begin() + poll_index);
+    loop->destroyClient(client);
+    --_clientCount;
+    ++loop->getStats().closed;
 
-    std::cout << "  Client removed" << std::endl;
-    std::cout << "  Remaining clients: " << _clients.size() << std::endl;
+    LogLine(LOG_INFO) << "[CLIENT REMOVED] FD " << client_fd << ": " << queued << " bytes queued, "
+                      << flushed << " bytes flushed, remaining clients: " << (unsigned long)_clientCount;
 }
 
-// Boucle principale du serveur
-void Server::run()
+// Traite les minuteries échues de la boucle : une vérification en O(1) par client concerné
+void Server::expireTimers(EventLoop& loop, unsigned long now, std::vector<int>& expired)
 {
-    _running = true;
+    expired.clear();
+    loop.getTimers().advance(now, expired);
+    if (expired.empty())
+        return;
 
-    std::cout << "\n=== SERVER STARTED ===" << std::endl;
-    std::cout << "Waiting for connections..." << std::endl;
-    std::cout << "Press Ctrl+C to stop\n" << std::endl;
+    ScopedLock lock(_stateLock);
 
-    while (_running)
+    for (size_t i = 0; i < expired.size(); ++i)
+    {
+        Client* client = loop.findClient(expired[i]);
+        if (!client || client->getTimer().isScheduled())
+            continue;
+        checkLiveness(loop, client, now);
+    }
+
+    loop.flushOutbox();
+}
+
+// Échéance d'un client : enregistrement non terminé, PING sans réponse, inactivité,
+// sinon PING après un silence de --ping-interval ; la minuterie est réarmée sur la prochaine échéance
+void Server::checkLiveness(EventLoop& loop, Client* client, unsigned long now)
+{
+    if (!client->isRegistered())
+    {
+        timeoutClient(client, "Registration timeout");
+        return;
+    }
+
+    if (client->isPingPending())
+    {
+        std::ostringstream reason;
+        reason << "Ping timeout: " << (now - client->getLastActivity()) / 1000 << " seconds";
+        timeoutClient(client, reason.str());
+        return;
+    }
+
+    unsigned long deadline = client->getLastActivity() + _config.pingInterval * 1000;
+    if (now >= deadline)
     {
-        // poll() surveille tous les file descriptors
-        int poll_count = poll(&_poll_fds[0], _poll_fds.size(), -1);
+        sendToClient(*client, "PING :" + _serverName);
+        client->setPingPending(true);
+        ++loop.getStats().pingsSent;
+        deadline = now + _config.pingTimeout * 1000;
+    }
 
-        if (poll_count < 0)
+    if (_config.idleTimeout)
+    {
+        unsigned long idleDeadline = client->getLastCommand() + _config.idleTimeout * 1000;
+        if (now >= idleDeadline)
+        {
+            timeoutClient(client, "Idle timeout");
+            return;
+        }
+        if (idleDeadline < deadline)
+            deadline = idleDeadline;
+    }
+
+    loop.getTimers().schedule(client->getTimer(), deadline);
+}
+
+// Prévient le client (ERROR) puis le déconnecte ; la raison est diffusée dans le QUIT
+void Server::timeoutClient(Client* client, const std::string& reason)
+{
+    LogLine(LOG_INFO) << "[TIMEOUT] FD " << client->getFd() << ": " << reason;
+    ++client->getLoop()->getStats().timeouts;
+    sendToClient(*client, "ERROR :Closing link (" + reason + ")");
+    disconnectClient(client, reason);
+}
+
+// Boucle d'une EventLoop : attente des événements de ses sockets et traitement
+void Server::runLoop(EventLoop& loop)
+{
+    EventLoop::setCurrent(&loop);
+    Poller* poller = loop.getPoller();
+    std::vector<int> deferred;
+    std::vector<int> expired;
+
+    while (_running)
+    {
+        // Le backend n'attend que les sockets actifs (epoll) ou tous (poll), au plus jusqu'à
+        // la reprise des clients ralentis ou la prochaine minuterie (PING, timeouts)
+        // La boucle 0 se réveille aussi pour retenter les liens sortants (--link)
+        int timeout = loop.nextTimeout(monotonic_ms());
+        if (loop.getId() == 0 && !_config.links.empty())
+            timeout = linkTimeout(monotonic_ms(), timeout);
+        int event_count = poller->wait(timeout);
+
+        if (event_count < 0)
         {
             if (errno == EINTR)
-                break;  // Signal reçu (ex: Ctrl+C) - on sort proprement
-            std::cerr << "Poll error: " << strerror(errno) << std::endl;
+                continue;  // Signal reçu (ex: Ctrl+C) - _running indique s'il faut sortir
+            LogLine(LOG_ERROR) << "Poll error: " << strerror(errno);
+            requestStop();
             break;
         }
 
-        // Parcourir tous les file descriptors surveillés
-        for (size_t i = 0; i < _poll_fds.size(); ++i)
+        // Parcourir uniquement les file descriptors prêts
+        const std::vector<PollerEvent>& events = poller->events();
+        for (size_t i = 0; i < events.size(); ++i)
         {
-            if (_poll_fds[i].revents & POLLIN)
+            int fd = events[i].fd;
+
+            if (fd == loop.getListenFd())
             {
-                if (_poll_fds[i].fd == _server_fd)
-                {
-                    acceptNewClient();
-                }
-                else
-                {
-                    size_t size_before = _poll_fds.size();
-                    readFromClient(i);
-                    if (_poll_fds.size() < size_before)
-                        --i;
-                }
+                if (events[i].readable)
+                    acceptNewClients(loop);
+                continue;
             }
+
+            // Export des métriques (boucle 0 uniquement)
+            if (fd == _metrics_fd && loop.getId() == 0)
+            {
+                acceptMetricsConnection();
+                continue;
+            }
+            if (loop.getId() == 0 && _metricsConnections.count(fd))
+            {
+                answerMetricsConnection(fd);
+                continue;
+            }
+
+            // Réveil : messages postés par les autres boucles ou arrêt demandé
+            if (fd == loop.getWakeFd())
+            {
+                loop.consumeWake();
+                loop.drainMailbox();
+                continue;
+            }
+
+            if (events[i].readable)
+                readFromClient(loop, fd);
+            if (events[i].writable)
+                writeToClient(loop, fd);
         }
+
+        // Lignes laissées en attente par le contrôle de flux dont le tour est venu
+        unsigned long now = monotonic_ms();
+        if (loop.takeDeferred(now, deferred))
+            resumeDeferred(loop, deferred);
+
+        // Échéances des clients (enregistrement, PING, inactivité)
+        expireTimers(loop, now, expired);
+
+        // Écoute suspendue après EMFILE/ENFILE dont le délai est échu
+        loop.resumeAccept(now);
+
+        // Liens sortants à (re)tenter (boucle 0)
+        if (loop.getId() == 0 && !_config.links.empty())
+            connectLinks(loop, now);
+
+        // Toutes les réponses du tour partent en un writev() par client
+        loop.flushClients();
+
+        // Compteurs d'allocations du thread, publiés pour STATS et l'export (zéro hors build ALLOC_STATS=1)
+        AllocCounters allocs = AllocStats::current();
+        loop.getStats().allocs = allocs.count;
+        loop.getStats().allocBytes = allocs.bytes;
+        loop.publishStats();
     }
-    std::cout << "\n=== SERVER STOPPED ===" << std::endl;
+
+    MessageBuffer::releasePool();
+    EventLoop::setCurrent(NULL);
 }
 
-// Arrête le serveur proprement
-void Server::stop()
+// Lance les boucles : la boucle 0 tourne dans le thread principal, les autres dans leurs threads
+void Server::run()
 {
-    _running = false;
+    _running = true;
 
-    std::cout << "\nClosing all connections..." << std::endl;
+    LogLine(LOG_INFO) << "=== SERVER STARTED === Waiting for connections (Ctrl+C to stop)";
 
-    // Fermer et libérer tous les clients
-    for (std::map<int, Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+    for (size_t i = 1; i < _loops.size(); ++i)
     {
-        close(it->second->getFd());
-        delete it->second;
+        if (!_loops[i]->start())
+        {
+            LogLine(LOG_ERROR) << "Failed to start event loop thread " << (unsigned long)i;
+            requestStop();
+        }
     }
-    _clients.clear();
 
-    // Libérer tous les channels
-    for (std::map<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
-        delete it->second;
+    if (_running)
+        runLoop(*_loops[0]);
+
+    for (size_t i = 1; i < _loops.size(); ++i)
+        _loops[i]->join();
+
+    LogLine(LOG_INFO) << "=== SERVER STOPPED ===";
+}
+
+// Demande l'arrêt de toutes les boucles (utilisable depuis un gestionnaire de signal)
+void Server::requestStop()
+{
+    _running = false;
+    for (size_t i = 0; i < _loops.size(); ++i)
+        _loops[i]->wake();
+}
+
+// Arrête le serveur proprement (les threads des boucles sont terminés)
+void Server::stop()
+{
+    _running = false;
+
+    LogLine(LOG_INFO) << "Closing all connections...";
+
+    // Libérer tous les channels (avant les clients : ils mettent à jour leurs index inverses)
+    for (HashMap<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
+        _channelPool.destroy(it->second);
     _channels.clear();
 
-    // Fermer le socket serveur
-    if (_server_fd >= 0)
+    // Utilisateurs distants (aucun socket : ils ne sont dans aucune boucle)
+    for (HashMap<std::string, Client*>::iterator it = _nicknames.begin(); it != _nicknames.end(); ++it)
     {
-        close(_server_fd);
-        _server_fd = -1;
+        if (it->second->isRemote())
+            _remotePool.destroy(it->second);
     }
+    _remoteUsers = 0;
+    _links.clear();
+    _servers.clear();
+    _linkTargets.clear();
 
-    _poll_fds.clear();
-
-    std::cout << "Server stopped cleanly." << std::endl;
+    // Fermer et libérer tous les clients de chaque boucle, puis les boucles
+    for (size_t i = 0; i < _loops.size(); ++i)
+    {
+        _loops[i]->destroyAllClients();
+        delete _loops[i];
+    }
+    _loops.clear();
+    _nicknames.clear();
+
+    // Export des métriques (ses sockets ne sont plus surveillés : les boucles sont détruites)
+    for (std::map<int, std::string>::iterator it = _metricsConnections.begin(); it != _metricsConnections.end(); ++it)
+        close(it->first);
+    _metricsConnections.clear();
+    if (_metrics_fd >= 0)
+        close(_metrics_fd);
+    _metrics_fd = -1;
+    _clientCount = 0;
+
+    // Buffers de messages relâchés par le thread principal pendant la fermeture
+    MessageBuffer::releasePool();
+
+    LogLine(LOG_INFO) << "Server stopped cleanly.";
 }
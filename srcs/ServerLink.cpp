@@ -0,0 +1,319 @@
+#include "Server.hpp"
+#include "EventLoop.hpp"
+#include "Logger.hpp"
+#include "CaseMap.hpp"
+#include "utils.hpp"
+#include <sys/socket.h>  // Pour socket(), connect()
+#include <netinet/in.h>  // Pour struct sockaddr_in
+#include <arpa/inet.h>   // Pour inet_pton()
+#include <unistd.h>      // Pour close()
+#include <cstring>       // Pour memset(), strerror()
+#include <cerrno>        // Pour errno
+#include <cstdlib>       // Pour std::atoi()
+
+// Description annoncée dans SERVER
+static const char* SERVER_DESCRIPTION = "ft_irc server";
+
+// Prépare les liens sortants de --link (tentés dès le premier tour de la boucle 0)
+void Server::setupLinks()
+{
+    for (size_t i = 0; i < _config.links.size(); ++i)
+    {
+        const std::string& address = _config.links[i];
+        size_t colon = address.rfind(':');
+
+        LinkTarget target;
+        target.host = address.substr(0, colon);
+        target.port = std::atoi(address.c_str() + colon + 1);
+        target.link = NULL;
+        target.nextAttempt = 0;
+        if (target.host == "localhost")
+            target.host = "127.0.0.1";
+        _linkTargets.push_back(target);
+    }
+}
+
+// Borne l'attente de la boucle 0 à la prochaine tentative de lien sortant
+int Server::linkTimeout(unsigned long now, int timeout)
+{
+    ScopedLock lock(_stateLock);
+    for (size_t i = 0; i < _linkTargets.size(); ++i)
+    {
+        if (_linkTargets[i].link)
+            continue;
+        int delay = _linkTargets[i].nextAttempt > now ? (int)(_linkTargets[i].nextAttempt - now) : 0;
+        if (timeout < 0 || delay < timeout)
+            timeout = delay;
+    }
+    return timeout;
+}
+
+// Ouvre les liens sortants dont la tentative est due (connexion non bloquante, boucle 0)
+// Un échec reprogramme la tentative ici, la chute d'un lien ouvert la reprogramme dans dropLink (même verrou)
+void Server::connectLinks(EventLoop& loop, unsigned long now)
+{
+    ScopedLock lock(_stateLock);
+    for (size_t i = 0; i < _linkTargets.size(); ++i)
+    {
+        LinkTarget& target = _linkTargets[i];
+        if (target.link || target.nextAttempt > now)
+            continue;
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(target.port);
+        if (inet_pton(AF_INET, target.host.c_str(), &addr.sin_addr) != 1)
+        {
+            LogLine(LOG_ERROR) << "[LINK] Invalid address: " << target.host;
+            target.nextAttempt = now + LINK_RETRY_MS;
+            continue;
+        }
+
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || !set_nonblocking(fd)
+            || (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS)
+            || !loop.getPoller()->add(fd))
+        {
+            LogLine(LOG_WARN) << "[LINK] Cannot connect to " << target.host << ":" << target.port << ": "
+                              << strerror(errno);
+            if (fd >= 0)
+                close(fd);
+            target.nextAttempt = now + LINK_RETRY_MS;
+            continue;
+        }
+
+        // La connexion est un client de la boucle 0 jusqu'au SERVER du pair (même échéance d'enregistrement)
+        Client* link = loop.createClient(fd);
+        link->setOutboundLink(true);
+        link->markActivity(now);
+        link->markCommand(now);
+        loop.getTimers().schedule(link->getTimer(), now + _config.registrationTimeout * 1000);
+        target.link = link;
+        if (++_clientCount > _peakClients)
+            _peakClients = _clientCount;
+
+        // Envoyées une fois la connexion établie (le socket devient inscriptible)
+        sendLinkIntroduction(*link);
+        LogLine(LOG_INFO) << "[LINK] Connecting to " << target.host << ":" << target.port << " (FD " << fd << ")";
+    }
+}
+
+// PASS <mot de passe> TS 6 puis SERVER <nom> 1 :<description>
+void Server::sendLinkIntroduction(Client& link)
+{
+    MessageBuilder out(_config.linkPassword.size() + _serverName.size() + 48);
+    out << "PASS " << _config.linkPassword << " TS 6\r\nSERVER " << _serverName << " 1 :" << SERVER_DESCRIPTION;
+    link.queueMessage(out.finish());
+}
+
+// La connexion devient un lien : annoncée aux autres serveurs, puis burst de tout l'état connu
+void Server::establishLink(Client& link, const std::string& name, const std::string& description)
+{
+    link.setServerLink(true);
+    link.setRegistered(true);
+    link.setServerName(name);
+    link.setHops(1);
+
+    RemoteServer server;
+    server.name = name;
+    server.link = &link;
+    server.hops = 1;
+    _servers.set(CaseMap::fold(name), server);
+    _links.push_back(&link);
+
+    MessageBuilder out(_serverName.size() + name.size() + description.size() + 20);
+    out << ':' << _serverName << " SERVER " << name << " 2 :" << description;
+    propagate(out.finish(), &link);
+
+    sendBurst(link);
+
+    LogLine(LOG_INFO) << "[LINK] Established with " << name << " (FD " << link.getFd() << "), "
+                      << (unsigned long)_links.size() << " link(s)";
+}
+
+// Burst : serveurs, utilisateurs puis channels connus qui ne viennent pas de ce lien
+void Server::sendBurst(Client& link)
+{
+    for (HashMap<std::string, RemoteServer>::iterator it = _servers.begin(); it != _servers.end(); ++it)
+    {
+        const RemoteServer& server = it->second;
+        if (server.link == &link)
+            continue;
+        MessageBuilder out(_serverName.size() + server.name.size() + 48);
+        out << ':' << _serverName << " SERVER " << server.name << ' ' << server.hops + 1 << " :"
+            << SERVER_DESCRIPTION;
+        link.queueMessage(out.finish());
+    }
+
+    for (HashMap<std::string, Client*>::iterator it = _nicknames.begin(); it != _nicknames.end(); ++it)
+    {
+        Client* user = it->second;
+        if (user->isRegistered() && user->getUplink() != &link)
+            link.queueMessage(userIntroduction(*user));
+    }
+
+    for (HashMap<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
+        sendChannelBurst(link, *it->second);
+}
+
+// SJOIN <ts> <channel> <modes> :<@op membre ...>, découpé pour tenir en lignes de 510 octets, puis le topic
+void Server::sendChannelBurst(Client& link, Channel& channel)
+{
+    std::string modes;
+    std::string params;
+    channel.formatModes(modes, params);
+
+    MessageBuilder head(_serverName.size() + channel.getName().size() + modes.size() + params.size() + 40);
+    head << ':' << _serverName << " SJOIN " << (unsigned long)channel.getCreatedAt() << ' ' << channel.getName()
+         << ' ' << modes << params << " :";
+    MessageRef header = head.finish();
+    size_t headerLength = header.size() - 2;
+
+    const std::vector<Client*>& members = channel.getMembers();
+    size_t i = 0;
+    while (i < members.size())
+    {
+        MessageBuilder out(Channel::LINE_LENGTH + 2);
+        out.append(header.data(), headerLength);
+        size_t length = headerLength;
+        size_t count = 0;
+
+        for (; i < members.size(); ++i)
+        {
+            Client* member = members[i];
+            if (member->getUplink() == &link)
+                continue;
+            size_t tokenLength = member->getNickname().size() + (channel.isOperator(member) ? 1 : 0);
+            if (count && length + 1 + tokenLength > Channel::LINE_LENGTH)
+                break;
+            if (count++)
+                out << ' ';
+            if (channel.isOperator(member))
+                out << '@';
+            out << member->getNickname();
+            length += tokenLength + 1;
+        }
+        if (count)
+            link.queueMessage(out.finish());
+    }
+
+    if (!channel.getTopic().empty())
+    {
+        MessageBuilder topic(_serverName.size() + channel.getName().size() + channel.getTopic().size() + 16);
+        topic << ':' << _serverName << " TOPIC " << channel.getName() << " :" << channel.getTopic();
+        link.queueMessage(topic.finish());
+    }
+}
+
+// Fermeture d'un lien (verrou pris) : netsplit des serveurs et utilisateurs qui se trouvaient derrière
+// Un lien sortant, établi ou non, est retenté après LINK_RETRY_MS
+void Server::dropLink(Client* link, const std::string& reason)
+{
+    if (link->isOutboundLink())
+    {
+        for (size_t i = 0; i < _linkTargets.size(); ++i)
+        {
+            if (_linkTargets[i].link == link)
+            {
+                _linkTargets[i].link = NULL;
+                _linkTargets[i].nextAttempt = monotonic_ms() + LINK_RETRY_MS;
+            }
+        }
+    }
+
+    if (!link->isServerLink())
+        return;
+
+    for (size_t i = 0; i < _links.size(); ++i)
+    {
+        if (_links[i] == link)
+        {
+            _links.erase(_links.begin() + i);
+            break;
+        }
+    }
+
+    // Serveurs derrière le lien : oubliés ici, SQUIT pour les autres voisins
+    std::vector<std::string> lostServers;
+    for (HashMap<std::string, RemoteServer>::iterator it = _servers.begin(); it != _servers.end(); ++it)
+    {
+        if (it->second.link == link)
+            lostServers.push_back(it->first);
+    }
+    for (size_t i = 0; i < lostServers.size(); ++i)
+    {
+        RemoteServer* server = _servers.find(lostServers[i]);
+        MessageBuilder out(_serverName.size() + server->name.size() + reason.size() + 20);
+        out << ':' << _serverName << " SQUIT " << server->name << " :" << reason;
+        propagate(out.finish(), link);
+        _servers.erase(lostServers[i]);
+    }
+
+    // Utilisateurs derrière le lien : QUIT "<ce serveur> <serveur perdu>" ici et chez les autres voisins
+    std::vector<Client*> lostUsers;
+    for (HashMap<std::string, Client*>::iterator it = _nicknames.begin(); it != _nicknames.end(); ++it)
+    {
+        if (it->second->getUplink() == link)
+            lostUsers.push_back(it->second);
+    }
+    std::string splitReason = _serverName + " " + link->getServerName();
+    for (size_t i = 0; i < lostUsers.size(); ++i)
+    {
+        propagateQuit(*lostUsers[i], splitReason, link);
+        removeRemoteUser(lostUsers[i], splitReason);
+    }
+
+    LogLine(LOG_INFO) << "[LINK] Lost " << link->getServerName() << " (" << reason << "): "
+                      << (unsigned long)lostServers.size() << " server(s), " << (unsigned long)lostUsers.size()
+                      << " user(s)";
+}
+
+// Envoie un message d'état (utilisateurs, channels) à tous les liens sauf celui d'où il vient
+void Server::propagate(const MessageRef& message, Client* except)
+{
+    for (size_t i = 0; i < _links.size(); ++i)
+    {
+        if (_links[i] != except)
+            _links[i]->queueMessage(message);
+    }
+}
+
+// :<serveur> NICK <pseudo> <sauts> <ts> <utilisateur> <serveur de l'utilisateur>
+MessageRef Server::userIntroduction(Client& user)
+{
+    const std::string& home = user.isRemote() ? user.getServerName() : _serverName;
+    MessageBuilder out(_serverName.size() + user.getNickname().size() + user.getUsername().size() + home.size() + 48);
+    out << ':' << _serverName << " NICK " << user.getNickname() << ' ' << user.getHops() + 1 << ' '
+        << (unsigned long)user.getNickTs() << ' ' << user.getUsername() << ' ' << home;
+    return out.finish();
+}
+
+// :<ancien pseudo> NICK <nouveau> :<ts>, vers les liens sauf except
+void Server::propagateNick(Client& user, const std::string& oldNick, Client* except)
+{
+    if (_links.empty())
+        return;
+    MessageBuilder out(oldNick.size() + user.getNickname().size() + 32);
+    out << ':' << oldNick << " NICK " << user.getNickname() << " :" << (unsigned long)user.getNickTs();
+    propagate(out.finish(), except);
+}
+
+// :<préfixe> QUIT :<raison>, vers les liens sauf except
+void Server::propagateQuit(Client& user, const std::string& reason, Client* except)
+{
+    if (_links.empty() || !user.isRegistered())
+        return;
+    MessageBuilder out(user.getPrefix().size() + reason.size() + 10);
+    out << user.getPrefix() << " QUIT :" << reason;
+    propagate(out.finish(), except);
+}
+
+// Retire un utilisateur distant : QUIT aux membres locaux de ses channels, puis index et pool
+void Server::removeRemoteUser(Client* user, const std::string& reason)
+{
+    removeClientFromAllChannels(user, reason);
+    unindexNickname(*user);
+    _remotePool.destroy(user);
+    --_remoteUsers;
+}
@@ -0,0 +1,201 @@
+#include "Server.hpp"
+#include "EventLoop.hpp"
+#include "Logger.hpp"
+#include "utils.hpp"
+#include "AllocStats.hpp"
+#include <sys/socket.h>  // Pour accept(), recv(), send()
+#include <unistd.h>      // Pour close()
+#include <cstring>       // Pour strerror()
+#include <cerrno>        // Pour errno
+#include <sstream>       // Pour std::ostringstream
+
+// Nombre maximal de connexions de l'export en attente de réponse
+static const size_t MAX_METRICS_CONNECTIONS = 16;
+
+// Ajoute une ligne "nom valeur" au format texte des métriques
+static void metric(std::ostringstream& out, const char* name, unsigned long value)
+{
+    out << "ircserv_" << name << " " << value << "\n";
+}
+
+// Ajoute une ligne par commande : ircserv_<nom>{command="<commande>"} valeur
+static void commandMetric(std::ostringstream& out, const char* name, const char* command, unsigned long value)
+{
+    out << "ircserv_" << name << "{command=\"" << command << "\"} " << value << "\n";
+}
+
+// Instantané des compteurs et jauges au format texte (une métrique par ligne)
+// Appelé verrou d'état pris ; les compteurs des boucles sont ceux publiés à la fin de leur dernier tour
+std::string Server::formatMetrics()
+{
+    LoopStats total;
+    for (size_t i = 0; i < _loops.size(); ++i)
+    {
+        LoopStats stats = _loops[i]->getPublishedStats();
+        total.accepted += stats.accepted;
+        total.closed += stats.closed;
+        total.bytesIn += stats.bytesIn;
+        total.bytesOut += stats.bytesOut;
+        total.shortWrites += stats.shortWrites;
+        total.writes += stats.writes;
+        total.messagesIn += stats.messagesIn;
+        total.messagesOut += stats.messagesOut;
+        total.floodDeferrals += stats.floodDeferrals;
+        total.readPauses += stats.readPauses;
+        total.pingsSent += stats.pingsSent;
+        total.timeouts += stats.timeouts;
+        total.allocs += stats.allocs;
+        total.allocBytes += stats.allocBytes;
+    }
+
+    size_t largestChannel = 0;
+    size_t peakChannel = 0;
+    unsigned long broadcasts = 0;
+    for (HashMap<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
+    {
+        Channel* channel = it->second;
+        if (channel->getMembers().size() > largestChannel)
+            largestChannel = channel->getMembers().size();
+        if (channel->getPeakMembers() > peakChannel)
+            peakChannel = channel->getPeakMembers();
+        broadcasts += channel->getBroadcasts();
+    }
+
+    std::ostringstream out;
+    metric(out, "uptime_seconds", time(NULL) - _startTime);
+    metric(out, "threads", _loops.size());
+    metric(out, "clients", _clientCount);
+    metric(out, "clients_peak", _peakClients);
+    metric(out, "links", _links.size());
+    metric(out, "servers", _servers.size());
+    metric(out, "remote_users", _remoteUsers);
+    metric(out, "connections_accepted_total", total.accepted);
+    metric(out, "connections_closed_total", total.closed);
+    metric(out, "channels", _channels.size());
+    metric(out, "channel_members_max", largestChannel);
+    metric(out, "channel_members_peak", peakChannel);
+    metric(out, "channel_broadcasts_total", broadcasts);
+    metric(out, "messages_received_total", total.messagesIn);
+    metric(out, "messages_sent_total", total.messagesOut);
+    metric(out, "bytes_received_total", total.bytesIn);
+    metric(out, "bytes_sent_total", total.bytesOut);
+    metric(out, "send_calls_total", total.writes);
+    metric(out, "send_short_writes_total", total.shortWrites);
+    metric(out, "flood_deferrals_total", total.floodDeferrals);
+    metric(out, "flood_read_pauses_total", total.readPauses);
+    metric(out, "pings_sent_total", total.pingsSent);
+    metric(out, "timeouts_total", total.timeouts);
+    metric(out, "log_lines_dropped_total", Logger::dropped());
+    if (AllocStats::enabled())
+    {
+        metric(out, "heap_allocations_total", total.allocs);
+        metric(out, "heap_allocated_bytes_total", total.allocBytes);
+    }
+
+    for (size_t i = 0; i < _commands.size(); ++i)
+    {
+        const CommandEntry& entry = _commands[i];
+        commandMetric(out, "command_calls_total", entry.name, entry.calls);
+        commandMetric(out, "command_bytes_total", entry.name, entry.bytes);
+        commandMetric(out, "command_replies_total", entry.name, entry.replies);
+        if (AllocStats::enabled())
+        {
+            commandMetric(out, "command_allocations_total", entry.name, entry.allocs);
+            commandMetric(out, "command_allocated_bytes_total", entry.name, entry.allocBytes);
+        }
+    }
+    return out.str();
+}
+
+// Ouvre l'export des métriques sur 127.0.0.1 (surveillé par la boucle 0)
+void Server::setupMetrics()
+{
+    _metrics_fd = createListener(_config.metricsPort, true, false, 16);
+    if (!_loops[0]->getPoller()->add(_metrics_fd))
+        error_exit("Failed to watch metrics socket");
+
+    LogLine(LOG_INFO) << "Metrics available on 127.0.0.1:" << _config.metricsPort;
+}
+
+// Accepte une connexion de l'export ; la réponse part quand la requête est lisible
+void Server::acceptMetricsConnection()
+{
+    int fd = accept(_metrics_fd, NULL, NULL);
+    if (fd < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            LogLine(LOG_WARN) << "Metrics accept error: " << strerror(errno);
+        return;
+    }
+
+    if (_metricsConnections.size() >= MAX_METRICS_CONNECTIONS || !set_nonblocking(fd)
+        || !_loops[0]->getPoller()->add(fd))
+    {
+        close(fd);
+        return;
+    }
+    _metricsConnections[fd];
+}
+
+// Répond à une requête (HTTP ou simple ligne) par l'instantané texte, puis ferme une fois tout envoyé
+// Une réponse qui ne tient pas dans le socket garde la connexion, surveillée en écriture jusqu'à la fin
+void Server::answerMetricsConnection(int fd)
+{
+    std::string& pending = _metricsConnections[fd];
+
+    if (pending.empty())
+    {
+        char request[1024];
+        ssize_t received = recv(fd, request, sizeof(request), 0);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (received <= 0)
+        {
+            closeMetricsConnection(fd);
+            return;
+        }
+
+        std::string body;
+        {
+            ScopedLock lock(_stateLock);
+            body = formatMetrics();
+        }
+
+        std::ostringstream response;
+        response << "HTTP/1.0 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        pending = response.str();
+    }
+
+    while (!pending.empty())
+    {
+        ssize_t sent = send(fd, pending.data(), pending.size(), 0);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Suite au prochain POLLOUT ; la requête déjà lue n'est plus surveillée
+                _loops[0]->getPoller()->setReadInterest(fd, false);
+                _loops[0]->getPoller()->setWriteInterest(fd, true);
+                return;
+            }
+            LogLine(LOG_WARN) << "Metrics send error: " << strerror(errno);
+            break;
+        }
+        pending.erase(0, sent);
+    }
+    closeMetricsConnection(fd);
+}
+
+// Ferme une connexion de l'export des métriques (boucle 0)
+void Server::closeMetricsConnection(int fd)
+{
+    _loops[0]->getPoller()->remove(fd);
+    close(fd);
+    _metricsConnections.erase(fd);
+}
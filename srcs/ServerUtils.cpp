@@ -1,102 +1,143 @@
 #include "Server.hpp"
-#include <sys/socket.h>  // Pour send()
 #include <iostream>      // Pour std::cout, std::cerr
-#include <cctype>        // Pour std::toupper()
+#include "CaseMap.hpp"
+#include <cstring>       // Pour std::strlen()
 
-// Envoie un message brut à un client via son socket
+// Met un message brut dans la file d'envoi d'un client
 void Server::sendToClient(Client& client, const std::string& message)
 {
-    // Ajouter \r\n si pas déjà présent (format IRC obligatoire)
-    std::string msg = message;
-    if (msg.length() < 2 || msg.substr(msg.length() - 2) != "\r\n")
-        msg += "\r\n";
+    // Écrit une seule fois dans le buffer partagé (\r\n ajouté si absent, format IRC obligatoire)
+    MessageBuilder out(message.size() + 2);
+    out << message;
+    client.queueMessage(out.finish());
+}
 
-    send(client.getFd(), msg.c_str(), msg.length(), 0);
+// Écrit le début d'une réponse numérique ":<serveur> <code> <pseudo> " (* avant NICK)
+void Server::beginNumeric(MessageBuilder& out, Client& client, const char* code)
+{
+    out << ':' << _serverName << ' ' << code << ' ';
+    if (client.getNickname().empty())
+        out << '*';
+    else
+        out << client.getNickname();
+    out << ' ';
+}
+
+// Envoie une réponse numérique IRC au format :servername CODE nick message
+// Un utilisateur distant n'en reçoit pas : son serveur a déjà répondu à la commande d'origine
+void Server::sendNumericReply(Client& client, const char* code, const std::string& message)
+{
+    if (client.isRemote())
+        return;
+    MessageBuilder out(_serverName.size() + client.getNickname().size() + message.size() + 16);
+    beginNumeric(out, client, code);
+    out << message;
+    client.queueMessage(out.finish());
 }
 
-// Envoie une réponse numérique IRC au format :servername CODE nick :message
-void Server::sendNumericReply(Client& client, const std::string& code, const std::string& message)
+// Envoie une réponse numérique "<cible> <texte>" sans concaténation préalable
+void Server::sendNumericReply(Client& client, const char* code, const StringRef& target, const char* text)
 {
-    std::string nick = client.getNickname().empty() ? "*" : client.getNickname();
-    std::string reply = ":" + _serverName + " " + code + " " + nick + " " + message;
-    sendToClient(client, reply);
+    if (client.isRemote())
+        return;
+    MessageBuilder out(_serverName.size() + client.getNickname().size() + target.size() + std::strlen(text) + 16);
+    beginNumeric(out, client, code);
+    out << target << ' ' << text;
+    client.queueMessage(out.finish());
 }
 
-// Construit le préfixe IRC d'un client (:nick!user@host)
-std::string Server::getClientPrefix(Client& client)
+// Même chose avec deux paramètres avant le texte ("<pseudo> <channel> <texte>")
+void Server::sendNumericReply(Client& client, const char* code, const StringRef& target, const StringRef& other,
+                              const char* text)
 {
-    return ":" + client.getNickname() + "!" + client.getUsername() + "@localhost";
+    if (client.isRemote())
+        return;
+    MessageBuilder out(_serverName.size() + client.getNickname().size() + target.size() + other.size()
+                       + std::strlen(text) + 16);
+    beginNumeric(out, client, code);
+    out << target << ' ' << other << ' ' << text;
+    client.queueMessage(out.finish());
 }
 
-// Extrait le premier mot (la commande IRC) du message et le met en majuscules
-std::string Server::extractCommand(const std::string& message)
+// Cherche un client par son pseudo dans l'index des nicknames (seul le nom cherché est replié)
+Client* Server::findClientByNickname(const StringRef& nickname)
 {
-    size_t start = message.find_first_not_of(" \t\r");
-    if (start == std::string::npos)
-        return "";
-    
-    std::string trimmed = message.substr(start);
-    
-    size_t space = trimmed.find_first_of(" \t");
-    std::string cmd = (space != std::string::npos) ? trimmed.substr(0, space) : trimmed;
-
-    for (size_t i = 0; i < cmd.size(); ++i)
-        cmd[i] = std::toupper(cmd[i]);
-
-    return cmd;
+    CaseMap::fold(nickname.data, nickname.length, _lookupKey);
+    Client** found = _nicknames.find(_lookupKey);
+    return found ? *found : NULL;
 }
 
-// Extrait tout après la commande (les paramètres)
-std::string Server::extractParams(const std::string& message)
+// Cherche un channel par son nom dans la table des channels (seul le nom cherché est replié)
+Channel* Server::findChannel(const StringRef& name)
 {
-    size_t start = message.find_first_not_of(" \t\r");
-    if (start == std::string::npos)
-        return "";
-    
-    std::string trimmed = message.substr(start);
-    
-    size_t space = trimmed.find_first_of(" \t");
-    if (space == std::string::npos)
-        return "";
-
-    std::string params = trimmed.substr(space + 1);
-    size_t paramStart = params.find_first_not_of(" \t");
-    if (paramStart == std::string::npos)
-        return "";
-    
-    return params.substr(paramStart);
+    CaseMap::fold(name.data, name.length, _lookupKey);
+    Channel** found = _channels.find(_lookupKey);
+    return found ? *found : NULL;
 }
 
-// Cherche un client par son pseudo dans la map des clients
-Client* Server::findClientByNickname(const std::string& nickname)
+// Remplace l'ancien pseudo du client par le nouveau dans l'index
+void Server::indexNickname(Client& client, const std::string& oldFolded)
 {
-    for (std::map<int, Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+    if (!oldFolded.empty())
     {
-        if (it->second->getNickname() == nickname)
-            return it->second;
+        Client** found = _nicknames.find(oldFolded);
+        if (found && *found == &client)
+            _nicknames.erase(oldFolded);
     }
+    _nicknames.set(client.getFoldedNickname(), &client);
+}
+
+// Retire le pseudo du client de l'index (déconnexion)
+void Server::unindexNickname(Client& client)
+{
+    const std::string& folded = client.getFoldedNickname();
+    if (folded.empty())
+        return;
 
-    return NULL;
+    Client** found = _nicknames.find(folded);
+    if (found && *found == &client)
+        _nicknames.erase(folded);
 }
 
-// Retire un client de tous les channels (appelé lors de la déconnexion)
-void Server::removeClientFromAllChannels(Client* client)
+// Crée un channel (emplacement pris dans le pool) et l'enregistre sous son nom replié
+Channel* Server::createChannel(const std::string& name)
 {
-    for (std::map<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); )
-    {
-        std::string quitMsg = getClientPrefix(*client) + " QUIT :Connection closed\r\n";
+    Channel* channel = new (_channelPool.allocate()) Channel(name);
+    _channels.set(channel->getFoldedName(), channel);
+    return channel;
+}
 
-        if (it->second->isMember(client))
-            it->second->broadcastMessage(quitMsg, client);
+// Retire un channel de la table et rend son emplacement au pool
+void Server::destroyChannel(Channel* channel)
+{
+    _channels.erase(channel->getFoldedName());
+    _channelPool.destroy(channel);
+}
+
+// Retire un client des seuls channels qu'il a rejoints (appelé lors de la déconnexion)
+void Server::removeClientFromAllChannels(Client* client, const std::string& reason)
+{
+    // Copies : removeMember() et removeInvited() modifient les index inverses du client
+    std::set<Channel*> joined = client->getChannels();
+    std::set<Channel*> invitations = client->getInvitations();
 
-        it->second->removeMember(client);
+    for (std::set<Channel*>::iterator it = invitations.begin(); it != invitations.end(); ++it)
+        (*it)->removeInvited(client);
+
+    if (joined.empty())
+        return;
+
+    MessageBuilder out(client->getPrefix().size() + reason.size() + 10);
+    out << client->getPrefix() << " QUIT :" << reason;
+    MessageRef quitMsg = out.finish();
+
+    for (std::set<Channel*>::iterator it = joined.begin(); it != joined.end(); ++it)
+    {
+        Channel* channel = *it;
+        channel->broadcastMessage(quitMsg, client);
+        channel->removeMember(client);
 
-        if (it->second->getMembers().empty())
-        {
-            delete it->second;
-            _channels.erase(it++);  // Post-incrémentation pour éviter l'invalidation de l'itérateur
-        }
-        else
-            ++it;
+        if (channel->getMembers().empty())
+            destroyChannel(channel);
     }
 }
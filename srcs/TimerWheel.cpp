@@ -0,0 +1,114 @@
+#include "TimerWheel.hpp"
+#include <climits>  // Pour INT_MAX
+
+// Minuterie désarmée
+TimerNode::TimerNode() : prev(NULL), next(NULL), expires(0), id(-1)
+{
+}
+
+bool TimerNode::isScheduled() const
+{
+    return next != NULL;
+}
+
+// Constructeur : toutes les cases sont des listes vides (sentinelle pointant sur elle-même)
+TimerWheel::TimerWheel(unsigned long now) : _nextTick(now / TICK_MS), _count(0)
+{
+    for (size_t i = 0; i < SLOTS; ++i)
+    {
+        _slots[i].prev = &_slots[i];
+        _slots[i].next = &_slots[i];
+    }
+}
+
+// Détache la minuterie de la liste de sa case
+void TimerWheel::unlink(TimerNode& node)
+{
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = NULL;
+    node.next = NULL;
+    --_count;
+}
+
+// Insère la minuterie en fin de sa case (une case déjà écoulée est remplacée par la prochaine)
+void TimerWheel::schedule(TimerNode& node, unsigned long expires)
+{
+    if (node.isScheduled())
+        unlink(node);
+
+    unsigned long tick = expires / TICK_MS;
+    if (tick < _nextTick)
+        tick = _nextTick;
+
+    TimerNode& head = _slots[tick % SLOTS];
+    node.expires = expires;
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+    ++_count;
+}
+
+// Désarme la minuterie
+void TimerWheel::cancel(TimerNode& node)
+{
+    if (node.isScheduled())
+        unlink(node);
+}
+
+// Parcourt les cases entièrement écoulées (au plus un tour) et expire leurs minuteries échues
+void TimerWheel::advance(unsigned long now, std::vector<int>& expired)
+{
+    unsigned long nowTick = now / TICK_MS;
+    if (nowTick <= _nextTick)
+        return;
+
+    unsigned long ticks = nowTick - _nextTick;
+    if (ticks > SLOTS)
+        ticks = SLOTS;
+
+    for (unsigned long i = 0; i < ticks; ++i)
+    {
+        TimerNode& head = _slots[(_nextTick + i) % SLOTS];
+        TimerNode* node = head.next;
+        while (node != &head)
+        {
+            TimerNode* next = node->next;
+            // Les minuteries des tours suivants restent dans la case
+            if (node->expires <= now)
+            {
+                unlink(*node);
+                expired.push_back(node->id);
+            }
+            node = next;
+        }
+    }
+    _nextTick = nowTick;
+}
+
+// Cherche la prochaine case non vide : la boucle se réveille à la fin de celle-ci
+int TimerWheel::timeout(unsigned long now) const
+{
+    if (_count == 0)
+        return -1;
+
+    for (unsigned long tick = _nextTick; tick < _nextTick + SLOTS; ++tick)
+    {
+        const TimerNode& head = _slots[tick % SLOTS];
+        if (head.next == &head)
+            continue;
+
+        unsigned long deadline = (tick + 1) * TICK_MS;
+        if (deadline <= now)
+            return 0;
+        unsigned long delay = deadline - now;
+        return delay > INT_MAX ? INT_MAX : (int)delay;
+    }
+    return -1;
+}
+
+size_t TimerWheel::size() const
+{
+    return _count;
+}
@@ -1,9 +1,11 @@
 #include "Server.hpp"
-#include <iostream>  // Pour std::cout
+#include "Logger.hpp"
+#include "CaseMap.hpp"
 #include <cctype>    // Pour std::isalpha(), std::isalnum()
+#include <ctime>     // Pour time()
 
 // Gère la commande PASS : vérifie le mot de passe du serveur
-void Server::handlePass(Client& client, const std::string& params)
+void Server::handlePass(Client& client, const IrcMessage& msg)
 {
     if (client.isRegistered())
     {
@@ -11,16 +13,26 @@ void Server::handlePass(Client& client, const std::string& params)
         return;
     }
 
-    if (params.empty())
+    if (msg.param(0).empty())
     {
         sendNumericReply(client, "461", "PASS :Not enough parameters");
         return;
     }
 
-    if (params == _password)
+    // PASS <mot de passe des liens> TS 6 : un serveur pair, qui se présentera avec SERVER
+    if (msg.paramCount >= 3 && msg.param(1) == "TS")
+    {
+        if (!_config.linkPassword.empty() && msg.param(0) == StringRef(_config.linkPassword))
+            client.setLinkAuthenticated(true);
+        else
+            sendNumericReply(client, "464", ":Password incorrect");
+        return;
+    }
+
+    if (msg.param(0) == StringRef(_password))
     {
         client.setAuthenticated(true);
-        std::cout << "[AUTH] FD " << client.getFd() << ": Password accepted" << std::endl;
+        LogLine(LOG_INFO) << "[AUTH] FD " << client.getFd() << ": Password accepted";
     }
     else
     {
@@ -29,9 +41,9 @@ void Server::handlePass(Client& client, const std::string& params)
 }
 
 // Gère la commande NICK : définir ou changer le pseudo
-void Server::handleNick(Client& client, const std::string& params)
+void Server::handleNick(Client& client, const IrcMessage& msg)
 {
-    if (params.empty())
+    if (msg.param(0).empty())
     {
         sendNumericReply(client, "431", ":No nickname given");
         return;
@@ -43,16 +55,14 @@ void Server::handleNick(Client& client, const std::string& params)
         return;
     }
 
-    std::string nickname = params;
-    size_t space = nickname.find(' ');
-    if (space != std::string::npos)
-        nickname = nickname.substr(0, space);
+    std::string nickname = msg.param(0).str();
 
-    if (!std::isalpha(nickname[0]) && nickname[0] != '[' && nickname[0] != ']'
+    if (nickname.size() > Client::NICK_LENGTH
+        || (!std::isalpha(nickname[0]) && nickname[0] != '[' && nickname[0] != ']'
         && nickname[0] != '\\' && nickname[0] != '^' && nickname[0] != '_'
-        && nickname[0] != '{' && nickname[0] != '}' && nickname[0] != '|')
+        && nickname[0] != '{' && nickname[0] != '}' && nickname[0] != '|'))
     {
-        sendNumericReply(client, "432", nickname + " :Erroneous nickname");
+        sendNumericReply(client, "432", nickname, ":Erroneous nickname");
         return;
     }
 
@@ -62,7 +72,7 @@ void Server::handleNick(Client& client, const std::string& params)
         if (!std::isalnum(c) && c != '[' && c != ']' && c != '\\'
             && c != '^' && c != '_' && c != '{' && c != '}' && c != '|' && c != '-')
         {
-            sendNumericReply(client, "432", nickname + " :Erroneous nickname");
+            sendNumericReply(client, "432", nickname, ":Erroneous nickname");
             return;
         }
     }
@@ -70,32 +80,41 @@ void Server::handleNick(Client& client, const std::string& params)
     Client* existing = findClientByNickname(nickname);
     if (existing && existing != &client)
     {
-        sendNumericReply(client, "433", nickname + " :Nickname is already in use");
+        sendNumericReply(client, "433", nickname, ":Nickname is already in use");
         return;
     }
 
     std::string oldNick = client.getNickname();
+    std::string oldFolded = client.getFoldedNickname();
+
+    // Annoncé avec l'ancien préfixe (avant que setNickname ne le recalcule)
+    MessageBuilder nickMsg(client.getPrefix().size() + nickname.size() + 10);
+    nickMsg << client.getPrefix() << " NICK :" << nickname;
 
     client.setNickname(nickname);
-    std::cout << "[NICK] FD " << client.getFd() << ": " << nickname << std::endl;
+    client.setNickTs(time(NULL));
+    indexNickname(client, oldFolded);
+    LogLine(LOG_INFO) << "[NICK] FD " << client.getFd() << ": " << nickname;
 
     if (client.isRegistered() && !oldNick.empty())
     {
-        std::string nickMsg = ":" + oldNick + "!" + client.getUsername() + "@localhost NICK :" + nickname + "\r\n";
-        sendToClient(client, nickMsg);
-        
-        for (std::map<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
+        MessageRef announce = nickMsg.finish();
+        client.queueMessage(announce);
+
+        const std::set<Channel*>& joined = client.getChannels();
+        for (std::set<Channel*>::const_iterator it = joined.begin(); it != joined.end(); ++it)
         {
-            if (it->second->isMember(&client))
-                it->second->broadcastMessage(nickMsg, &client);
+            (*it)->renameMember(&client, oldNick);
+            (*it)->broadcastMessage(announce, &client);
         }
+        propagateNick(client, oldNick, NULL);
     }
 
     checkRegistration(client);
 }
 
 // Gère la commande USER : définir le nom d'utilisateur
-void Server::handleUser(Client& client, const std::string& params)
+void Server::handleUser(Client& client, const IrcMessage& msg)
 {
     if (client.isRegistered())
     {
@@ -103,7 +122,7 @@ void Server::handleUser(Client& client, const std::string& params)
         return;
     }
 
-    if (params.empty())
+    if (msg.param(0).empty())
     {
         sendNumericReply(client, "461", "USER :Not enough parameters");
         return;
@@ -115,13 +134,10 @@ void Server::handleUser(Client& client, const std::string& params)
         return;
     }
 
-    std::string username = params;
-    size_t space = username.find(' ');
-    if (space != std::string::npos)
-        username = username.substr(0, space);
+    std::string username = msg.param(0).str();
 
     client.setUsername(username);
-    std::cout << "[USER] FD " << client.getFd() << ": " << username << std::endl;
+    LogLine(LOG_INFO) << "[USER] FD " << client.getFd() << ": " << username;
 
     checkRegistration(client);
 }
@@ -136,41 +152,41 @@ void Server::checkRegistration(Client& client)
     {
         client.setRegistered(true);
 
-        std::string welcome = ":Welcome to the " + _serverName + " Network, "
-            + client.getNickname() + "!" + client.getUsername() + "@localhost";
-        sendNumericReply(client, "001", welcome);
-
-        std::cout << "[REGISTERED] " << client.getNickname() << " is now registered" << std::endl;
+        // RPL_WELCOME : le préfixe en cache sans son ':'
+        const std::string& prefix = client.getPrefix();
+        MessageBuilder welcome(_serverName.size() * 2 + prefix.size() + 48);
+        beginNumeric(welcome, client, "001");
+        welcome << ":Welcome to the " << _serverName << " Network, " << StringRef(prefix.data() + 1, prefix.size() - 1);
+        client.queueMessage(welcome.finish());
+
+        // RPL_ISUPPORT : paramètres dont dépend l'interprétation des noms par le client
+        MessageBuilder isupport(_serverName.size() * 2 + client.getNickname().size() + 128);
+        beginNumeric(isupport, client, "005");
+        isupport << "CASEMAPPING=" << CaseMap::name() << " CHANTYPES=# PREFIX=(o)@ CHANMODES=,k,l,it"
+                 << " TARGMAX=JOIN:,PART:,PRIVMSG:" << (unsigned long)MAX_TARGETS
+                 << " NICKLEN=" << (unsigned long)Client::NICK_LENGTH
+                 << " CHANNELLEN=" << (unsigned long)Channel::NAME_LENGTH
+                 << " NETWORK=" << _serverName << " :are supported by this server";
+        client.queueMessage(isupport.finish());
+
+        // Présenté aux serveurs pairs, horodaté à l'enregistrement (collisions de pseudos)
+        client.setNickTs(time(NULL));
+        if (!_links.empty())
+            propagate(userIntroduction(client), NULL);
+
+        LogLine(LOG_INFO) << "[REGISTERED] " << client.getNickname() << " is now registered";
     }
 }
 
 // Gère la commande QUIT : déconnexion volontaire du client
-void Server::handleQuit(Client& client, const std::string& params)
+void Server::handleQuit(Client& client, const IrcMessage& msg)
 {
     std::string message = "Quit";
-    if (!params.empty())
-    {
-        message = params;
-        if (message[0] == ':')
-            message = message.substr(1);
-    }
+    if (!msg.param(0).empty())
+        message = msg.param(0).str();
 
-    std::string quitMsg = getClientPrefix(client) + " QUIT :" + message + "\r\n";
+    LogLine(LOG_INFO) << "[QUIT] " << client.getNickname() << ": " << message;
 
-    for (std::map<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
-    {
-        if (it->second->isMember(&client))
-            it->second->broadcastMessage(quitMsg, &client);
-    }
-
-    std::cout << "[QUIT] " << client.getNickname() << ": " << message << std::endl;
-
-    for (size_t i = 1; i < _poll_fds.size(); ++i)
-    {
-        if (_poll_fds[i].fd == client.getFd())
-        {
-            disconnectClient(i);
-            return;
-        }
-    }
+    // La déconnexion diffuse le QUIT aux seuls channels rejoints
+    disconnectClient(&client, message);
 }
\ No newline at end of file
@@ -1,38 +1,46 @@
 #include "Server.hpp"
-#include <iostream>  // Pour std::cout
+#include "Logger.hpp"
 
-// Gère la commande JOIN : rejoindre un salon
-void Server::handleJoin(Client& client, const std::string& params)
+// Gère la commande JOIN : rejoindre un ou plusieurs salons
+// JOIN #a,#b,#c clé1,clé2 : la i-ème clé va au i-ème channel (les channels en trop n'en ont pas)
+void Server::handleJoin(Client& client, const IrcMessage& msg)
 {
-    if (params.empty())
+    if (msg.param(0).empty())
     {
         sendNumericReply(client, "461", "JOIN :Not enough parameters");
         return;
     }
 
-    std::string channelName = params;
-    std::string key = "";
-    size_t space = params.find(' ');
-    if (space != std::string::npos)
+    const StringRef& channels = msg.param(0);
+    const StringRef& keys = msg.param(1);
+    size_t channelPos = 0;
+    size_t keyPos = 0;
+    StringRef channelName;
+    StringRef key;
+
+    while (nextListItem(channels, channelPos, channelName))
     {
-        channelName = params.substr(0, space);
-        key = params.substr(space + 1);
+        if (!nextListItem(keys, keyPos, key))
+            key = StringRef();
+        if (!channelName.empty())
+            joinChannel(client, channelName.str(), key.str());
     }
+}
 
-    if (channelName.empty() || channelName[0] != '#')
+// Fait rejoindre un channel au client (le crée s'il n'existe pas)
+void Server::joinChannel(Client& client, std::string channelName, const std::string& key)
+{
+    if (channelName.empty() || channelName[0] != '#' || channelName.size() > Channel::NAME_LENGTH)
     {
-        sendNumericReply(client, "476", channelName + " :Bad Channel Mask");
+        sendNumericReply(client, "476", channelName, ":Bad Channel Mask");
         return;
     }
 
     // Chercher si le channel existe déjà
-    Channel* channel = NULL;
-    std::map<std::string, Channel*>::iterator it = _channels.find(channelName);
+    Channel* channel = findChannel(channelName);
 
-    if (it != _channels.end())
+    if (channel)
     {
-        channel = it->second;
-
         // Vérifier si le client est déjà membre
         if (channel->isMember(&client))
             return;
@@ -40,14 +48,14 @@ void Server::handleJoin(Client& client, const std::string& params)
         // Vérifier le mode invitation seulement (+i)
         if (channel->isInviteOnly() && !channel->isInvited(&client))
         {
-            sendNumericReply(client, "473", channelName + " :Cannot join channel (+i)");
+            sendNumericReply(client, "473", channelName, ":Cannot join channel (+i)");
             return;
         }
 
         // Vérifier le mot de passe du channel (+k)
         if (!channel->getKey().empty() && key != channel->getKey())
         {
-            sendNumericReply(client, "475", channelName + " :Cannot join channel (+k)");
+            sendNumericReply(client, "475", channelName, ":Cannot join channel (+k)");
             return;
         }
 
@@ -55,103 +63,120 @@ void Server::handleJoin(Client& client, const std::string& params)
         if (channel->getUserLimit() > 0
             && (int)channel->getMembers().size() >= channel->getUserLimit())
         {
-            sendNumericReply(client, "471", channelName + " :Cannot join channel (+l)");
+            sendNumericReply(client, "471", channelName, ":Cannot join channel (+l)");
             return;
         }
     }
-    else
+    bool created = !channel;
+    if (created)
     {
-        channel = new Channel(channelName);
-        _channels[channelName] = channel;
+        channel = createChannel(channelName);
 
         channel->addOperator(&client);
 
-        std::cout << "[CHANNEL] Created: " << channelName << std::endl;
+        LogLine(LOG_INFO) << "[CHANNEL] Created: " << channelName;
     }
 
     channel->addMember(&client);
     channel->removeInvited(&client);
 
-    std::string joinMsg = getClientPrefix(client) + " JOIN " + channelName + "\r\n";
-    channel->broadcastMessageAll(joinMsg);
+    // Les réponses reprennent le nom tel qu'à la création du channel (#Ops rejoint en #OPS)
+    channelName = channel->getName();
 
-    if (!channel->getTopic().empty())
-        sendNumericReply(client, "332", channelName + " :" + channel->getTopic());
+    MessageBuilder joinMsg(client.getPrefix().size() + channelName.size() + 8);
+    joinMsg << client.getPrefix() << " JOIN " << channelName;
+    channel->broadcastMessageAll(joinMsg.finish());
 
-    // Construire la liste des membres pour RPL_NAMREPLY (353)
-    std::string namesList = "";
-    std::vector<Client*>& members = channel->getMembers();
-    for (size_t i = 0; i < members.size(); ++i)
+    if (!channel->getTopic().empty())
     {
-        if (i > 0)
-            namesList += " ";
-
-        if (channel->isOperator(members[i]))
-            namesList += "@";
+        MessageBuilder topic(_serverName.size() + channelName.size() + channel->getTopic().size() + 64);
+        beginNumeric(topic, client, "332");
+        topic << channelName << " :" << channel->getTopic();
+        client.queueMessage(topic.finish());
+    }
 
-        namesList += members[i]->getNickname();
+    // Envoyer RPL_NAMREPLY (353), une ligne par bloc pré-rendu du channel, puis RPL_ENDOFNAMES (366)
+    const std::vector<std::string>& names = channel->getNamesLines();
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i].empty())
+            continue;
+        MessageBuilder reply(_serverName.size() + channelName.size() + names[i].size() + 64);
+        beginNumeric(reply, client, "353");
+        reply << "= " << channelName << " :" << names[i];
+        client.queueMessage(reply.finish());
     }
+    sendNumericReply(client, "366", channelName, ":End of /NAMES list");
 
-    // Envoyer RPL_NAMREPLY (353) et RPL_ENDOFNAMES (366)
-    sendNumericReply(client, "353", "= " + channelName + " :" + namesList);
-    sendNumericReply(client, "366", channelName + " :End of /NAMES list");
+    // Serveurs pairs : SJOIN horodaté (le créateur y est opérateur)
+    if (!_links.empty())
+    {
+        MessageBuilder sjoin(_serverName.size() + channelName.size() + client.getNickname().size() + 40);
+        sjoin << ':' << _serverName << " SJOIN " << (unsigned long)channel->getCreatedAt() << ' ' << channelName
+              << " + :" << (created ? "@" : "") << client.getNickname();
+        propagate(sjoin.finish(), NULL);
+    }
 
-    std::cout << "[JOIN] " << client.getNickname() << " joined " << channelName << std::endl;
+    LogLine(LOG_INFO) << "[JOIN] " << client.getNickname() << " joined " << channelName;
 }
 
-// Gère la commande PART : quitter un salon
-void Server::handlePart(Client& client, const std::string& params)
+// Gère la commande PART : quitter un ou plusieurs salons (PART #a,#b :message)
+void Server::handlePart(Client& client, const IrcMessage& msg)
 {
-    if (params.empty())
+    if (msg.param(0).empty())
     {
         sendNumericReply(client, "461", "PART :Not enough parameters");
         return;
     }
 
-    std::string channelName = params;
-    std::string message = "";
-    size_t space = params.find(' ');
-    if (space != std::string::npos)
+    const StringRef& channels = msg.param(0);
+    std::string message = msg.param(1).str();
+    size_t pos = 0;
+    StringRef channelName;
+
+    while (nextListItem(channels, pos, channelName))
     {
-        channelName = params.substr(0, space);
-        message = params.substr(space + 1);
-        if (!message.empty() && message[0] == ':')
-            message = message.substr(1);
+        if (!channelName.empty())
+            partChannel(client, channelName.str(), message);
     }
+}
 
+// Retire le client d'un channel (le détruit s'il devient vide)
+void Server::partChannel(Client& client, const std::string& requestedName, const std::string& message)
+{
     // Vérifier que le channel existe
-    std::map<std::string, Channel*>::iterator it = _channels.find(channelName);
-    if (it == _channels.end())
+    Channel* channel = findChannel(requestedName);
+    if (!channel)
     {
-        sendNumericReply(client, "403", channelName + " :No such channel");
+        sendNumericReply(client, "403", requestedName, ":No such channel");
         return;
     }
 
-    Channel* channel = it->second;
-
     // Vérifier que le client est membre du channel
     if (!channel->isMember(&client))
     {
-        sendNumericReply(client, "442", channelName + " :You're not on that channel");
+        sendNumericReply(client, "442", requestedName, ":You're not on that channel");
         return;
     }
+    std::string channelName = channel->getName();
 
     // Construire le message PART
-    std::string partMsg = getClientPrefix(client) + " PART " + channelName;
+    MessageBuilder partMsg(client.getPrefix().size() + channelName.size() + message.size() + 10);
+    partMsg << client.getPrefix() << " PART " << channelName;
     if (!message.empty())
-        partMsg += " :" + message;
-    partMsg += "\r\n";
+        partMsg << " :" << message;
 
-    channel->broadcastMessageAll(partMsg);
+    MessageRef part = partMsg.finish();
+    channel->broadcastMessageAll(part);
+    propagate(part, client.getUplink());
     channel->removeMember(&client);
 
     // Si le channel est vide, le supprimer
     if (channel->getMembers().empty())
     {
-        delete channel;
-        _channels.erase(it);
-        std::cout << "[CHANNEL] Deleted: " << channelName << std::endl;
+        destroyChannel(channel);
+        LogLine(LOG_INFO) << "[CHANNEL] Deleted: " << channelName;
     }
 
-    std::cout << "[PART] " << client.getNickname() << " left " << channelName << std::endl;
+    LogLine(LOG_INFO) << "[PART] " << client.getNickname() << " left " << channelName;
 }
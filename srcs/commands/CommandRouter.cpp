@@ -1,46 +1,149 @@
 #include "Server.hpp"
-#include <iostream>  // Pour std::cout
+#include "IrcMessage.hpp"
+#include "Logger.hpp"
+#include "EventLoop.hpp"
+#include "utils.hpp"
+#include "AllocStats.hpp"
+#include <cctype>    // Pour std::toupper()
+#include <cstring>   // Pour std::strlen()
 
-// Traite une commande IRC reçue d'un client (routeur principal)
-void Server::processCommand(Client& client, const std::string& command)
+// Packe un nom de commande (8 caractères max) en entier, en majuscules
+// Retourne 0 si le nom est vide ou trop long (aucune commande ne correspond)
+static uint64_t packCommand(const char* name, size_t length)
 {
-    std::cout << "[COMMAND] FD " << client.getFd() << ": " << command << std::endl;
+    if (length == 0 || length > 8)
+        return 0;
 
-    std::string cmd = extractCommand(command);
-    std::string params = extractParams(command);
+    uint64_t key = 0;
+    for (size_t i = 0; i < length; ++i)
+        key |= (uint64_t)(unsigned char)std::toupper(name[i]) << (8 * i);
+    return key;
+}
 
-    // Les commandes PASS, NICK, USER sont toujours autorisées (avant enregistrement)
-    if (cmd == "PASS")
-        return handlePass(client, params);
-    if (cmd == "NICK")
-        return handleNick(client, params);
-    if (cmd == "USER")
-        return handleUser(client, params);
-    if (cmd == "QUIT")
-        return handleQuit(client, params);
+// Case de départ d'une clé dans la table (hachage multiplicatif)
+static size_t commandSlot(uint64_t key, size_t slots)
+{
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (slots - 1);
+}
+
+// Construit la table de dispatch (appelé une fois au démarrage)
+void Server::initCommands()
+{
+    for (size_t i = 0; i < COMMAND_SLOTS; ++i)
+        _commandSlots[i] = -1;
+
+    // Les commandes PASS, NICK, USER, QUIT, PING, PONG sont toujours autorisées (avant enregistrement)
+    // PASS et USER vérifient eux-mêmes leurs paramètres, après ERR_ALREADYREGISTRED (462)
+    registerCommand("PASS", &Server::handlePass, false, 0);
+    registerCommand("NICK", &Server::handleNick, false, 0);
+    registerCommand("USER", &Server::handleUser, false, 0);
+    registerCommand("QUIT", &Server::handleQuit, false, 0);
+    registerCommand("PING", &Server::handlePing, false, 0);
+    registerCommand("PONG", &Server::handlePong, false, 0);
+    registerCommand("SERVER", &Server::handleServer, false, 1);
 
     // Toutes les autres commandes nécessitent un enregistrement complet
-    if (!client.isRegistered())
+    registerCommand("JOIN", &Server::handleJoin, true, 1);
+    registerCommand("PART", &Server::handlePart, true, 1);
+    registerCommand("PRIVMSG", &Server::handlePrivmsg, true, 0);
+    registerCommand("KICK", &Server::handleKick, true, 2);
+    registerCommand("INVITE", &Server::handleInvite, true, 2);
+    registerCommand("TOPIC", &Server::handleTopic, true, 1);
+    registerCommand("MODE", &Server::handleMode, true, 1);
+    registerCommand("OPER", &Server::handleOper, true, 2);
+    registerCommand("STATS", &Server::handleStats, true, 1);
+}
+
+// Ajoute une commande à la table (sondage linéaire en cas de collision)
+void Server::registerCommand(const char* name, CommandHandler handler, bool needsRegistration, size_t minParams)
+{
+    CommandEntry entry;
+    entry.key = packCommand(name, std::strlen(name));
+    entry.name = name;
+    entry.handler = handler;
+    entry.needsRegistration = needsRegistration;
+    entry.minParams = minParams;
+    entry.calls = 0;
+    entry.remoteCalls = 0;
+    entry.bytes = 0;
+    entry.replies = 0;
+    entry.allocs = 0;
+    entry.allocBytes = 0;
+
+    size_t slot = commandSlot(entry.key, COMMAND_SLOTS);
+    while (_commandSlots[slot] != -1)
+        slot = (slot + 1) & (COMMAND_SLOTS - 1);
+
+    _commandSlots[slot] = _commands.size();
+    _commands.push_back(entry);
+}
+
+// Cherche une commande par son nom (insensible à la casse), NULL si inconnue
+Server::CommandEntry* Server::findCommand(const StringRef& command)
+{
+    uint64_t key = packCommand(command.data, command.length);
+    if (key == 0)
+        return NULL;
+
+    for (size_t slot = commandSlot(key, COMMAND_SLOTS); _commandSlots[slot] != -1;
+         slot = (slot + 1) & (COMMAND_SLOTS - 1))
+    {
+        CommandEntry& entry = _commands[_commandSlots[slot]];
+        if (entry.key == key)
+            return &entry;
+    }
+    return NULL;
+}
+
+// Traite une commande IRC reçue d'un client (routeur principal)
+void Server::processCommand(Client& client, const char* line, size_t length)
+{
+    (LogLine(LOG_DEBUG) << "[COMMAND] FD " << client.getFd() << ": ").write(line, length);
+
+    // Découpage unique de la ligne : chaque handler reçoit le message structuré
+    IrcMessage msg;
+    if (!parseIrcMessage(line, length, msg))
+        return;
+
+    CommandEntry* entry = findCommand(msg.command);
+
+    // Commande inconnue ou réservée aux clients enregistrés
+    if (!client.isRegistered() && (!entry || entry->needsRegistration))
     {
         sendNumericReply(client, "451", ":You have not registered");
         return;
     }
+    if (!entry)
+    {
+        std::string cmd = msg.command.str();
+        for (size_t i = 0; i < cmd.size(); ++i)
+            cmd[i] = std::toupper(cmd[i]);
+        sendNumericReply(client, "421", cmd, ":Unknown command");
+        return;
+    }
+
+    if (msg.paramCount < entry->minParams)
+    {
+        sendNumericReply(client, "461", StringRef(entry->name, std::strlen(entry->name)), ":Not enough parameters");
+        return;
+    }
+
+    // PING/PONG entretiennent la connexion sans compter comme une activité (--idle-timeout)
+    if (entry->handler != &Server::handlePing && entry->handler != &Server::handlePong)
+        client.markCommand(monotonic_ms());
+
+    // Les messages et allocations produits par le handler lui sont attribués
+    EventLoop* loop = EventLoop::current();
+    unsigned long before = loop ? loop->getStats().messagesOut : 0;
+    AllocCounters allocsBefore = AllocStats::current();
+
+    ++entry->calls;
+    entry->bytes += length;
+    (this->*(entry->handler))(client, msg);
 
-    // Router les commandes qui nécessitent un enregistrement
-    if (cmd == "JOIN")
-        handleJoin(client, params);
-    else if (cmd == "PART")
-        handlePart(client, params);
-    else if (cmd == "PRIVMSG")
-        handlePrivmsg(client, params);
-    else if (cmd == "KICK")
-        handleKick(client, params);
-    else if (cmd == "INVITE")
-        handleInvite(client, params);
-    else if (cmd == "TOPIC")
-        handleTopic(client, params);
-    else if (cmd == "MODE")
-        handleMode(client, params);
-    else
-        sendNumericReply(client, "421", cmd + " :Unknown command");
+    AllocCounters allocsAfter = AllocStats::current();
+    entry->allocs += allocsAfter.count - allocsBefore.count;
+    entry->allocBytes += allocsAfter.bytes - allocsBefore.bytes;
+    if (loop)
+        entry->replies += loop->getStats().messagesOut - before;
 }
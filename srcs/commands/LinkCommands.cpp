@@ -0,0 +1,497 @@
+#include "Server.hpp"
+#include "Logger.hpp"
+#include "CaseMap.hpp"
+#include "utils.hpp"
+#include <sstream>    // Pour std::ostringstream
+#include <cstdlib>    // Pour std::strtoul(), std::atoi()
+#include <ctime>      // Pour time()
+
+// Nombre décimal d'un paramètre (ts, sauts) ; 0 s'il est invalide
+static unsigned long toNumber(const StringRef& value)
+{
+    std::string text = value.str();
+    return std::strtoul(text.c_str(), NULL, 10);
+}
+
+// Gère la commande SERVER : après PASS <mot de passe des liens> TS 6, la connexion devient un lien
+void Server::handleServer(Client& client, const IrcMessage& msg)
+{
+    // SERVER <nom> <sauts> :<description>
+    if (client.isRegistered())
+    {
+        sendNumericReply(client, "462", ":You may not reregister");
+        return;
+    }
+
+    std::string name = msg.param(0).str();
+    std::string folded = CaseMap::fold(name);
+    std::string reason;
+    if (!client.isLinkAuthenticated())
+        reason = "Bad link password";
+    else if (name.find_first_of("!@#,*") != std::string::npos)
+        reason = "Invalid server name";
+    else if (folded == CaseMap::fold(_serverName) || _servers.find(folded))
+        reason = "Server " + name + " already exists";
+
+    if (!reason.empty())
+    {
+        LogLine(LOG_WARN) << "[LINK] Refused " << name << " (FD " << client.getFd() << "): " << reason;
+        sendToClient(client, "ERROR :Closing link (" + reason + ")");
+        disconnectClient(&client, reason);
+        return;
+    }
+
+    // Lien entrant : le pair attend à son tour notre présentation (un lien sortant l'a déjà envoyée)
+    if (!client.isOutboundLink())
+        sendLinkIntroduction(client);
+
+    establishLink(client, name, msg.param(2).str());
+}
+
+// Traite une ligne reçue d'un serveur pair (verrou d'état pris)
+// La source est le serveur voisin ou un utilisateur joignable par ce lien ; une commande d'un
+// utilisateur inconnu ou venu d'ailleurs est périmée (collision de pseudos résolue entre-temps)
+void Server::processLinkMessage(Client& link, const char* line, size_t length)
+{
+    (LogLine(LOG_DEBUG) << "[LINK] " << link.getServerName() << ": ").write(line, length);
+
+    IrcMessage msg;
+    if (!parseIrcMessage(line, length, msg))
+        return;
+
+    // Un lien n'est jamais inactif au sens de --idle-timeout
+    link.markCommand(monotonic_ms());
+
+    const StringRef& command = msg.command;
+    if (command == "PING")
+    {
+        sendToClient(link, ":" + _serverName + " PONG " + _serverName + " :" + msg.param(0).str());
+        return;
+    }
+    if (command == "PONG")
+        return;
+    if (command == "ERROR")
+    {
+        LogLine(LOG_WARN) << "[LINK] " << link.getServerName() << " reports: " << msg.param(0).str();
+        return;
+    }
+
+    // Préfixe nick!user@host ou nom d'utilisateur : la commande vient d'un utilisateur distant
+    Client* user = NULL;
+    StringRef source = msg.prefix;
+    for (size_t i = 0; i < source.length; ++i)
+    {
+        if (source.data[i] == '!')
+            source.length = i;
+    }
+    if (!source.empty())
+    {
+        CaseMap::fold(source.data, source.length, _lookupKey);
+        if (!_servers.find(_lookupKey))
+        {
+            user = findClientByNickname(source);
+            if (!user || user->getUplink() != &link)
+                return;
+        }
+    }
+
+    if (!user)
+    {
+        if (command == "SERVER")
+            linkServer(link, msg);
+        else if (command == "SQUIT")
+            linkSquit(link, msg);
+        else if (command == "NICK")
+            linkUser(link, msg);
+        else if (command == "SJOIN")
+            linkSjoin(link, msg);
+        else if (command == "TOPIC")
+            linkTopic(link, msg);
+        return;
+    }
+
+    if (command == "NICK")
+    {
+        linkNick(link, *user, msg);
+        return;
+    }
+    if (command == "QUIT")
+    {
+        std::string reason = msg.param(0).str();
+        propagateQuit(*user, reason, &link);
+        removeRemoteUser(user, reason);
+        return;
+    }
+
+    // Commandes d'utilisateurs distants : les handlers des clients appliquent, diffusent
+    // aux membres locaux et propagent ; leurs réponses d'erreur ne sont pas renvoyées
+    CommandEntry* entry = findCommand(command);
+    if (!entry || msg.paramCount < entry->minParams)
+        return;
+    if (entry->handler != &Server::handlePrivmsg && entry->handler != &Server::handlePart
+        && entry->handler != &Server::handleKick && entry->handler != &Server::handleTopic
+        && entry->handler != &Server::handleMode && entry->handler != &Server::handleInvite)
+        return;
+
+    // Une invitation ne repart pas vers le lien d'où elle vient (états divergents)
+    if (entry->handler == &Server::handleInvite)
+    {
+        Client* target = findClientByNickname(msg.param(0));
+        if (target && target->getUplink() == &link)
+            return;
+    }
+
+    ++entry->remoteCalls;
+    entry->bytes += length;
+    (this->*(entry->handler))(*user, msg);
+}
+
+// :<voisin> SERVER <nom> <sauts> :<description> — un serveur au-delà du voisin
+void Server::linkServer(Client& link, const IrcMessage& msg)
+{
+    std::string name = msg.param(0).str();
+    std::string folded = CaseMap::fold(name);
+
+    // Déjà connu : le réseau formerait une boucle, le lien qui l'annonce est coupé
+    if (name.empty() || folded == CaseMap::fold(_serverName) || _servers.find(folded))
+    {
+        std::string reason = "Server " + name + " already exists";
+        LogLine(LOG_WARN) << "[LINK] " << link.getServerName() << ": " << reason;
+        sendToClient(link, "ERROR :Closing link (" + reason + ")");
+        disconnectClient(&link, reason);
+        return;
+    }
+
+    RemoteServer server;
+    server.name = name;
+    server.link = &link;
+    server.hops = toNumber(msg.param(1));
+    _servers.set(folded, server);
+
+    MessageBuilder out(_serverName.size() + name.size() + msg.param(2).size() + 40);
+    out << ':' << _serverName << " SERVER " << name << ' ' << server.hops + 1 << " :" << msg.param(2);
+    propagate(out.finish(), &link);
+
+    LogLine(LOG_INFO) << "[LINK] " << name << " introduced by " << link.getServerName();
+}
+
+// :<voisin> SQUIT <nom> :<raison> — un serveur au-delà du voisin a quitté le réseau
+// (ses utilisateurs sont retirés un par un par les QUIT qui suivent)
+void Server::linkSquit(Client& link, const IrcMessage& msg)
+{
+    std::string folded = CaseMap::fold(msg.param(0).str());
+    RemoteServer* server = _servers.find(folded);
+    if (!server || server->link != &link)
+        return;
+
+    MessageBuilder out(_serverName.size() + server->name.size() + msg.param(1).size() + 20);
+    out << ':' << _serverName << " SQUIT " << server->name << " :" << msg.param(1);
+    propagate(out.finish(), &link);
+
+    LogLine(LOG_INFO) << "[LINK] " << server->name << " split from " << link.getServerName();
+    _servers.erase(folded);
+}
+
+// :<voisin> NICK <pseudo> <sauts> <ts> <utilisateur> <serveur> — un utilisateur rejoint le réseau
+// (un pseudo plus long que NICK_LENGTH est ignoré, comme il le serait d'un client local)
+void Server::linkUser(Client& link, const IrcMessage& msg)
+{
+    if (msg.paramCount < 5 || msg.param(0).size() > Client::NICK_LENGTH)
+        return;
+
+    const StringRef& nick = msg.param(0);
+    time_t ts = (time_t)toNumber(msg.param(2));
+
+    Client* existing = findClientByNickname(nick);
+    if (existing && !resolveCollision(link, existing, ts))
+        return;
+
+    Client* user = new (_remotePool.allocate()) Client(-1, NULL);
+    ++_remoteUsers;
+    user->setNickname(nick.str());
+    user->setUsername(msg.param(3).str());
+    user->setAuthenticated(true);
+    user->setRegistered(true);
+    user->setUplink(&link);
+    user->setServerName(msg.param(4).str());
+    user->setHops(toNumber(msg.param(1)));
+    user->setNickTs(ts);
+    indexNickname(*user, "");
+
+    propagate(userIntroduction(*user), &link);
+}
+
+// :<ancien pseudo> NICK <nouveau> :<ts> — changement de pseudo d'un utilisateur distant
+void Server::linkNick(Client& link, Client& user, const IrcMessage& msg)
+{
+    std::string nickname = msg.param(0).str();
+    time_t ts = (time_t)toNumber(msg.param(1));
+    if (nickname.empty() || nickname.size() > Client::NICK_LENGTH)
+        return;
+
+    // Pseudo pris ici entre-temps : si l'utilisateur perd, son serveur le renommera en recevant
+    // le gagnant ; d'ici là il disparaît de ce côté du réseau
+    Client* existing = findClientByNickname(nickname);
+    if (existing && existing != &user && !resolveCollision(link, existing, ts))
+    {
+        propagateQuit(user, "Nick collision", &link);
+        removeRemoteUser(&user, "Nick collision");
+        return;
+    }
+
+    std::string oldNick = user.getNickname();
+    std::string oldFolded = user.getFoldedNickname();
+    MessageBuilder nickMsg(user.getPrefix().size() + nickname.size() + 10);
+    nickMsg << user.getPrefix() << " NICK :" << nickname;
+    MessageRef announce = nickMsg.finish();
+
+    user.setNickname(nickname);
+    user.setNickTs(ts);
+    indexNickname(user, oldFolded);
+
+    const std::set<Channel*>& joined = user.getChannels();
+    for (std::set<Channel*>::const_iterator it = joined.begin(); it != joined.end(); ++it)
+    {
+        (*it)->renameMember(&user, oldNick);
+        (*it)->broadcastMessage(announce, &user);
+    }
+
+    propagateNick(user, oldNick, &link);
+}
+
+// Collision entre un pseudo connu et un arrivant horodaté incomingTs (venu de link) : le plus
+// ancien garde le pseudo, à égalité aucun des deux ; retourne true si l'arrivant le garde
+// Chaque serveur applique la même règle : un perdant local est renommé et réannoncé (saveUser),
+// un perdant distant est oublié ici (son serveur le réannonce sous son nouveau pseudo)
+bool Server::resolveCollision(Client& link, Client* existing, time_t incomingTs)
+{
+    time_t existingTs = existing->getNickTs();
+
+    LogLine(LOG_INFO) << "[LINK] Nick collision on " << existing->getNickname() << " with "
+                      << link.getServerName() << " (ts " << (unsigned long)existingTs << " vs "
+                      << (unsigned long)incomingTs << ")";
+
+    if (existingTs >= incomingTs)
+    {
+        if (existing->isRemote())
+        {
+            propagateQuit(*existing, "Nick collision", existing->getUplink());
+            removeRemoteUser(existing, "Nick collision");
+        }
+        else
+            saveUser(*existing, link);
+    }
+    return incomingTs < existingTs;
+}
+
+// Renomme un utilisateur local qui a perdu une collision (pseudo Guest<n> libre) : NICK pour lui,
+// ses channels et les liens qui le connaissent ; le lien du gagnant reçoit une nouvelle présentation
+// et les SJOIN de ses channels (il ne le connaissait pas sous l'ancien pseudo)
+void Server::saveUser(Client& user, Client& winnerLink)
+{
+    static unsigned long counter = (unsigned long)time(NULL) % 100000;
+
+    std::string nickname;
+    do
+    {
+        std::ostringstream oss;
+        oss << "Guest" << ++counter % 100000;
+        nickname = oss.str();
+    } while (findClientByNickname(nickname));
+
+    std::string oldNick = user.getNickname();
+    std::string oldFolded = user.getFoldedNickname();
+    MessageBuilder nickMsg(user.getPrefix().size() + nickname.size() + 10);
+    nickMsg << user.getPrefix() << " NICK :" << nickname;
+    MessageRef announce = nickMsg.finish();
+
+    user.setNickname(nickname);
+    user.setNickTs(time(NULL));
+    indexNickname(user, oldFolded);
+    user.queueMessage(announce);
+
+    const std::set<Channel*>& joined = user.getChannels();
+    for (std::set<Channel*>::const_iterator it = joined.begin(); it != joined.end(); ++it)
+    {
+        (*it)->renameMember(&user, oldNick);
+        (*it)->broadcastMessage(announce, &user);
+    }
+
+    propagateNick(user, oldNick, &winnerLink);
+    winnerLink.queueMessage(userIntroduction(user));
+    for (std::set<Channel*>::const_iterator it = joined.begin(); it != joined.end(); ++it)
+    {
+        Channel* channel = *it;
+        MessageBuilder sjoin(_serverName.size() + channel->getName().size() + nickname.size() + 40);
+        sjoin << ':' << _serverName << " SJOIN " << (unsigned long)channel->getCreatedAt() << ' '
+              << channel->getName() << " + :" << (channel->isOperator(&user) ? "@" : "") << nickname;
+        winnerLink.queueMessage(sjoin.finish());
+    }
+
+    LogLine(LOG_INFO) << "[LINK] " << oldNick << " lost a nick collision, renamed to " << nickname;
+}
+
+// Applique les modes +itkl d'un SJOIN (paramètres params[0..count[) ; retourne les modes appliqués
+static std::string applyChannelModes(Channel& channel, const StringRef& modes, const StringRef* params, size_t count)
+{
+    std::string applied;
+    std::string appliedParams;
+    size_t next = 0;
+
+    for (size_t i = 0; i < modes.size(); ++i)
+    {
+        switch (modes[i])
+        {
+            case 'i':
+                channel.setInviteOnly(true);
+                break;
+            case 't':
+                channel.setTopicRestricted(true);
+                break;
+            case 'k':
+                if (next >= count)
+                    continue;
+                channel.setKey(params[next].str());
+                appliedParams += " " + params[next++].str();
+                break;
+            case 'l':
+                if (next >= count || std::atoi(params[next].str().c_str()) <= 0)
+                    continue;
+                channel.setUserLimit(std::atoi(params[next].str().c_str()));
+                appliedParams += " " + params[next++].str();
+                break;
+            default:
+                continue;
+        }
+        applied += modes[i];
+    }
+    return applied.empty() ? applied : "+" + applied + appliedParams;
+}
+
+// :<voisin> SJOIN <ts> <channel> <modes> [paramètres] :<[@]pseudo ...> — arrivée de membres distants
+// Horodatages : le channel le plus ancien impose ses modes et ses opérateurs ; à égalité ils
+// s'additionnent ; un SJOIN plus récent n'apporte que des membres
+void Server::linkSjoin(Client& link, const IrcMessage& msg)
+{
+    if (msg.paramCount < 4 || msg.param(1).empty() || msg.param(1)[0] != '#'
+        || msg.param(1).size() > Channel::NAME_LENGTH)
+        return;
+
+    time_t ts = (time_t)toNumber(msg.param(0));
+    std::string name = msg.param(1).str();
+    const std::string& from = link.getServerName();
+
+    Channel* channel = findChannel(name);
+    if (!channel)
+    {
+        channel = createChannel(name);
+        channel->setCreatedAt(ts);
+        LogLine(LOG_INFO) << "[CHANNEL] Created: " << name << " (from " << from << ")";
+    }
+    else if (ts < channel->getCreatedAt())
+    {
+        // Le channel distant est plus ancien : nos modes et nos opérateurs tombent
+        std::string modes;
+        std::string params;
+        channel->formatModes(modes, params);
+        if (modes.size() > 1)
+        {
+            modes[0] = '-';
+            if (!channel->getKey().empty())
+                params = " " + channel->getKey();
+            else
+                params.clear();
+            channel->setInviteOnly(false);
+            channel->setTopicRestricted(false);
+            channel->setKey("");
+            channel->setUserLimit(0);
+            channel->broadcastMessageAll(":" + from + " MODE " + channel->getName() + " " + modes + params + "\r\n");
+        }
+
+        std::vector<Client*> members = channel->getMembers();
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            if (!channel->isOperator(members[i]))
+                continue;
+            channel->removeOperator(members[i]);
+            channel->broadcastMessageAll(":" + from + " MODE " + channel->getName() + " -o "
+                                         + members[i]->getNickname() + "\r\n");
+        }
+        channel->setCreatedAt(ts);
+    }
+    bool keepTheirs = ts <= channel->getCreatedAt();
+    name = channel->getName();
+
+    // Modes du SJOIN (entre la chaîne de modes et la liste des membres)
+    std::string modes;
+    if (keepTheirs)
+    {
+        modes = applyChannelModes(*channel, msg.param(2), msg.params + 3, msg.paramCount - 4);
+        if (!modes.empty())
+            channel->broadcastMessageAll(":" + from + " MODE " + name + " " + modes + "\r\n");
+    }
+
+    // Membres : seuls ceux joignables par ce lien sont acceptés
+    const StringRef& list = msg.param(msg.paramCount - 1);
+    std::string accepted;
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+        size_t end = pos;
+        while (end < list.size() && list[end] != ' ')
+            ++end;
+        StringRef token(list.data + pos, end - pos);
+        pos = end + 1;
+
+        bool op = !token.empty() && token[0] == '@';
+        StringRef nick(token.data + (op ? 1 : 0), token.size() - (op ? 1 : 0));
+        Client* user = nick.empty() ? NULL : findClientByNickname(nick);
+        if (!user || user->getUplink() != &link || channel->isMember(user))
+            continue;
+
+        channel->addMember(user);
+        channel->removeInvited(user);
+        MessageBuilder join(user->getPrefix().size() + name.size() + 8);
+        join << user->getPrefix() << " JOIN " << name;
+        channel->broadcastMessage(join.finish(), user);
+
+        op = op && keepTheirs;
+        if (op)
+        {
+            channel->addOperator(user);
+            channel->broadcastMessageAll(":" + from + " MODE " + name + " +o " + user->getNickname() + "\r\n");
+        }
+        if (!accepted.empty())
+            accepted += ' ';
+        accepted += (op ? "@" : "") + user->getNickname();
+    }
+
+    if (channel->getMembers().empty())
+    {
+        destroyChannel(channel);
+        return;
+    }
+    if (accepted.empty() && modes.empty())
+        return;
+
+    MessageBuilder out(_serverName.size() + name.size() + modes.size() + accepted.size() + 40);
+    out << ':' << _serverName << " SJOIN " << (unsigned long)channel->getCreatedAt() << ' ' << name << ' '
+        << (modes.empty() ? "+" : modes) << " :" << accepted;
+    propagate(out.finish(), &link);
+}
+
+// :<voisin> TOPIC <channel> :<topic> — topic d'un burst, retenu si le channel n'en a pas encore
+void Server::linkTopic(Client& link, const IrcMessage& msg)
+{
+    Channel* channel = findChannel(msg.param(0));
+    if (!channel || !channel->getTopic().empty() || msg.param(1).empty())
+        return;
+
+    std::string topic = msg.param(1).str();
+    channel->setTopic(topic);
+    channel->broadcastMessageAll(":" + link.getServerName() + " TOPIC " + channel->getName() + " :" + topic + "\r\n");
+
+    MessageBuilder out(_serverName.size() + channel->getName().size() + topic.size() + 16);
+    out << ':' << _serverName << " TOPIC " << channel->getName() << " :" << topic;
+    propagate(out.finish(), &link);
+}
@@ -1,24 +1,19 @@
 #include "Server.hpp"
 
-// Gère la commande PRIVMSG : envoyer un message à un channel ou un utilisateur
-void Server::handlePrivmsg(Client& client, const std::string& params)
+// Gère la commande PRIVMSG : envoyer un message à des channels et/ou des utilisateurs
+// PRIVMSG #a,#b,nick :texte — tout le lot est traité en une passe, et un destinataire présent
+// dans plusieurs cibles ne reçoit le message qu'une fois (avec la première cible qui l'atteint)
+void Server::handlePrivmsg(Client& client, const IrcMessage& msg)
 {
-    if (params.empty())
+    if (msg.param(0).empty())
     {
         sendNumericReply(client, "411", ":No recipient given (PRIVMSG)");
         return;
     }
 
-    std::string target = params;
-    std::string message = "";
-    size_t space = params.find(' ');
-    if (space != std::string::npos)
-    {
-        target = params.substr(0, space);
-        message = params.substr(space + 1);
-        if (!message.empty() && message[0] == ':')
-            message = message.substr(1);
-    }
+    // Cibles et texte restent des vues dans la ligne reçue
+    const StringRef& targets = msg.param(0);
+    const StringRef& message = msg.param(1);
 
     // Vérifier que le message n'est pas vide
     if (message.empty())
@@ -27,42 +22,103 @@ void Server::handlePrivmsg(Client& client, const std::string& params)
         return;
     }
 
-    // Construire le message au format IRC
-    std::string fullMsg = getClientPrefix(client) + " PRIVMSG " + target + " :" + message + "\r\n";
+    // Nouveau lot : les destinataires servis y sont marqués (aucun ensemble à allouer ni à vider)
+    // Les serveurs pairs concernés reçoivent la ligne entière une seule fois (construite au premier besoin)
+    unsigned long batch = ++_deliveryBatch;
+    MessageRef relay;
+    size_t pos = 0;
+    size_t count = 0;
+    StringRef target;
+    while (nextListItem(targets, pos, target))
+    {
+        if (target.empty())
+            continue;
+        if (++count > MAX_TARGETS)
+        {
+            sendNumericReply(client, "407", target, ":Too many targets");
+            break;
+        }
+        deliverPrivmsg(client, target, msg, batch, relay);
+    }
+}
+
+// Envoie le texte à une cible du lot : un channel (sauf l'expéditeur) ou un utilisateur
+void Server::deliverPrivmsg(Client& client, const StringRef& target, const IrcMessage& msg, unsigned long batch,
+                            MessageRef& relay)
+{
+    const StringRef& text = msg.param(1);
 
     // Vérifier si la cible est un channel (commence par #)
+    // Les recherches replient la cible dans une clé réutilisée : aucune chaîne allouée
+    Channel* channel = NULL;
+    Client* targetClient = NULL;
     if (target[0] == '#')
     {
-        std::map<std::string, Channel*>::iterator it = _channels.find(target);
-        if (it == _channels.end())
+        channel = findChannel(target);
+        if (!channel)
         {
-            sendNumericReply(client, "403", target + " :No such channel");
+            sendNumericReply(client, "403", target, ":No such channel");
             return;
         }
 
-        Channel* channel = it->second;
-
         // Le client doit être membre du channel
         if (!channel->isMember(&client))
         {
-            sendNumericReply(client, "442", target + " :You're not on that channel");
+            sendNumericReply(client, "442", target, ":You're not on that channel");
             return;
         }
-
-        // Envoyer le message à tous les membres sauf l'expéditeur
-        channel->broadcastMessage(fullMsg, &client);
     }
     else
     {
-        // Message privé vers un utilisateur
-        Client* targetClient = findClientByNickname(target);
+        // Message privé vers un utilisateur (déjà servi par une cible précédente : rien à faire)
+        targetClient = findClientByNickname(target);
         if (!targetClient)
         {
-            sendNumericReply(client, "401", target + " :No such nick/channel");
+            sendNumericReply(client, "401", target, ":No such nick/channel");
+            return;
+        }
+        if (!targetClient->markDelivered(batch))
+            return;
+
+        // Utilisateur d'un autre serveur : la ligne part sur le lien qui y mène
+        if (targetClient->isRemote())
+        {
+            relayPrivmsg(client, *targetClient->getUplink(), msg, batch, relay);
             return;
         }
+    }
+
+    // Message écrit une seule fois dans le buffer partagé : préfixe en cache, cible et texte copiés de la ligne reçue
+    MessageBuilder out(client.getPrefix().size() + target.size() + text.size() + 14);
+    out << client.getPrefix() << " PRIVMSG " << target << " :" << text;
+    MessageRef fullMsg = out.finish();
+
+    // Envoyer le message aux membres pas encore servis sauf l'expéditeur, ou directement au client cible
+    if (!channel)
+    {
+        targetClient->queueMessage(fullMsg);
+        return;
+    }
+    channel->broadcastMessageOnce(fullMsg, &client, batch);
+
+    // Seuls les serveurs pairs derrière lesquels le channel a des membres reçoivent son trafic
+    const std::vector<std::pair<Client*, size_t> >& links = channel->getLinks();
+    for (size_t i = 0; i < links.size(); ++i)
+        relayPrivmsg(client, *links[i].first, msg, batch, relay);
+}
 
-        // Envoyer le message directement au client cible
-        sendToClient(*targetClient, fullMsg);
+// Relaie la ligne PRIVMSG entière (toutes ses cibles) une fois par lien, jamais vers sa provenance :
+// le serveur pair la traite à son tour, avec son propre dédoublonnage des destinataires
+void Server::relayPrivmsg(Client& client, Client& link, const IrcMessage& msg, unsigned long batch, MessageRef& relay)
+{
+    if (&link == client.getUplink() || !link.markDelivered(batch))
+        return;
+
+    if (relay.empty())
+    {
+        MessageBuilder out(client.getPrefix().size() + msg.param(0).size() + msg.param(1).size() + 14);
+        out << client.getPrefix() << " PRIVMSG " << msg.param(0) << " :" << msg.param(1);
+        relay = out.finish();
     }
+    link.queueMessage(relay);
 }
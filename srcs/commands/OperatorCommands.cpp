@@ -1,65 +1,43 @@
 #include "Server.hpp"
-#include <iostream>   // Pour std::cout
+#include "Logger.hpp"
 #include <sstream>    // Pour std::ostringstream
 #include <cstdlib>    // Pour std::atoi()
 
 // Gère la commande KICK : expulser un utilisateur d'un channel
-void Server::handleKick(Client& client, const std::string& params)
+void Server::handleKick(Client& client, const IrcMessage& msg)
 {
-    if (params.empty())
+    // KICK <channel> <nick> [:raison]
+    if (msg.paramCount < 2 || msg.param(0).empty() || msg.param(1).empty())
     {
         sendNumericReply(client, "461", "KICK :Not enough parameters");
         return;
     }
 
-    // Extraire le nom du channel
-    std::string remaining = params;
-    std::string channelName = "";
-    size_t space = remaining.find(' ');
-    if (space != std::string::npos)
-    {
-        channelName = remaining.substr(0, space);
-        remaining = remaining.substr(space + 1);
-    }
-    else
-    {
-        sendNumericReply(client, "461", "KICK :Not enough parameters");
-        return;
-    }
-
-    // Extraire le pseudo de la cible et la raison optionnelle
-    std::string targetNick = remaining;
+    std::string channelName = msg.param(0).str();
+    std::string targetNick = msg.param(1).str();
     std::string reason = client.getNickname();  // Par défaut, le kicker est la raison
-    space = remaining.find(' ');
-    if (space != std::string::npos)
-    {
-        targetNick = remaining.substr(0, space);
-        reason = remaining.substr(space + 1);
-        if (!reason.empty() && reason[0] == ':')
-            reason = reason.substr(1);
-    }
+    if (!msg.param(2).empty())
+        reason = msg.param(2).str();
 
     // Vérifier que le channel existe
-    std::map<std::string, Channel*>::iterator it = _channels.find(channelName);
-    if (it == _channels.end())
+    Channel* channel = findChannel(channelName);
+    if (!channel)
     {
-        sendNumericReply(client, "403", channelName + " :No such channel");
+        sendNumericReply(client, "403", channelName, ":No such channel");
         return;
     }
 
-    Channel* channel = it->second;
-
     // Vérifier que le kicker est membre du channel
     if (!channel->isMember(&client))
     {
-        sendNumericReply(client, "442", channelName + " :You're not on that channel");
+        sendNumericReply(client, "442", channelName, ":You're not on that channel");
         return;
     }
 
     // Vérifier que le kicker est opérateur
     if (!channel->isOperator(&client))
     {
-        sendNumericReply(client, "482", channelName + " :You're not channel operator");
+        sendNumericReply(client, "482", channelName, ":You're not channel operator");
         return;
     }
 
@@ -67,46 +45,40 @@ void Server::handleKick(Client& client, const std::string& params)
     Client* target = findClientByNickname(targetNick);
     if (!target)
     {
-        sendNumericReply(client, "401", targetNick + " :No such nick/channel");
+        sendNumericReply(client, "401", targetNick, ":No such nick/channel");
         return;
     }
 
     // Vérifier que la cible est membre du channel
     if (!channel->isMember(target))
     {
-        sendNumericReply(client, "441", targetNick + " " + channelName + " :They aren't on that channel");
+        sendNumericReply(client, "441", targetNick, channelName, ":They aren't on that channel");
         return;
     }
 
     // Construire et envoyer le message KICK à tous les membres
-    std::string kickMsg = getClientPrefix(client) + " KICK " + channelName + " " + targetNick + " :" + reason + "\r\n";
+    MessageBuilder kickBuilder(client.getPrefix().size() + channelName.size() + targetNick.size() + reason.size() + 16);
+    kickBuilder << client.getPrefix() << " KICK " << channelName << ' ' << targetNick << " :" << reason;
+    MessageRef kickMsg = kickBuilder.finish();
     channel->broadcastMessageAll(kickMsg);
+    propagate(kickMsg, client.getUplink());
 
     // Retirer la cible du channel
     channel->removeMember(target);
 
     // Si le channel est vide, le supprimer
     if (channel->getMembers().empty())
-    {
-        delete channel;
-        _channels.erase(it);
-    }
+        destroyChannel(channel);
 
-    std::cout << "[KICK] " << client.getNickname() << " kicked " << targetNick << " from " << channelName << std::endl;
+    LogLine(LOG_INFO) << "[KICK] " << client.getNickname() << " kicked " << targetNick << " from " << channelName;
 }
 
 // Gère la commande INVITE : inviter un utilisateur dans un channel
-void Server::handleInvite(Client& client, const std::string& params)
+void Server::handleInvite(Client& client, const IrcMessage& msg)
 {
-    // Extraire nickname et channel
-    std::string nickname = params;
-    std::string channelName = "";
-    size_t space = params.find(' ');
-    if (space != std::string::npos)
-    {
-        nickname = params.substr(0, space);
-        channelName = params.substr(space + 1);
-    }
+    // INVITE <nick> <channel>
+    std::string nickname = msg.param(0).str();
+    std::string channelName = msg.param(1).str();
 
     // Vérifier paramètres
     if (nickname.empty() || channelName.empty())
@@ -116,26 +88,24 @@ void Server::handleInvite(Client& client, const std::string& params)
     }
 
     // Vérifier que le channel existe
-    std::map<std::string, Channel*>::iterator it = _channels.find(channelName);
-    if (it == _channels.end())
+    Channel* channel = findChannel(channelName);
+    if (!channel)
     {
-        sendNumericReply(client, "403", channelName + " :No such channel");
+        sendNumericReply(client, "403", channelName, ":No such channel");
         return;
     }
 
-    Channel* channel = it->second;
-
     // Le client doit être membre du channel
     if (!channel->isMember(&client))
     {
-        sendNumericReply(client, "442", channelName + " :You're not on that channel");
+        sendNumericReply(client, "442", channelName, ":You're not on that channel");
         return;
     }
 
     // Le client doit être opérateur
     if (!channel->isOperator(&client))
     {
-        sendNumericReply(client, "482", channelName + " :You're not channel operator");
+        sendNumericReply(client, "482", channelName, ":You're not channel operator");
         return;
     }
 
@@ -143,67 +113,63 @@ void Server::handleInvite(Client& client, const std::string& params)
     Client* targetClient = findClientByNickname(nickname);
     if (!targetClient)
     {
-        sendNumericReply(client, "401", nickname + " :No such nick/channel");
+        sendNumericReply(client, "401", nickname, ":No such nick/channel");
         return;
     }
 
     // Vérifier que la cible n'est pas déjà dans le channel
     if (channel->isMember(targetClient))
     {
-        sendNumericReply(client, "443", nickname + " " + channelName + " :is already on channel");
+        sendNumericReply(client, "443", nickname, channelName, ":is already on channel");
         return;
     }
 
     // Ajouter à la liste des invités
     channel->addInvited(targetClient);
 
-    // Notifier le client qui invite
-    sendNumericReply(client, "341", nickname + " " + channelName);
+    // Notifier le client qui invite (pas de réponse numérique vers un utilisateur distant)
+    if (!client.isRemote())
+    {
+        MessageBuilder reply(_serverName.size() + client.getNickname().size() + nickname.size() + channelName.size() + 16);
+        beginNumeric(reply, client, "341");
+        reply << nickname << ' ' << channelName;
+        client.queueMessage(reply.finish());
+    }
 
     // Notifier l'utilisateur invité
-    std::string inviteMsg = getClientPrefix(client) + " INVITE " + nickname + " " + channelName + "\r\n";
-    sendToClient(*targetClient, inviteMsg);
+    MessageBuilder inviteMsg(client.getPrefix().size() + nickname.size() + channelName.size() + 16);
+    inviteMsg << client.getPrefix() << " INVITE " << nickname << ' ' << channelName;
+    targetClient->queueMessage(inviteMsg.finish());
 
-    std::cout << "[INVITE] " << client.getNickname() << " invited " << nickname << " to " << channelName << std::endl;
+    LogLine(LOG_INFO) << "[INVITE] " << client.getNickname() << " invited " << nickname << " to " << channelName;
 }
 
 // Gère la commande TOPIC : voir ou changer le sujet d'un channel
-void Server::handleTopic(Client& client, const std::string& params)
+void Server::handleTopic(Client& client, const IrcMessage& msg)
 {
-    if (params.empty())
+    if (msg.param(0).empty())
     {
         sendNumericReply(client, "461", "TOPIC :Not enough parameters");
         return;
     }
 
-    // Extraire le nom du channel et le nouveau topic optionnel
-    std::string channelName = params;
-    std::string newTopic = "";
-    bool hasTopic = false;
-    size_t space = params.find(' ');
-    if (space != std::string::npos)
-    {
-        channelName = params.substr(0, space);
-        newTopic = params.substr(space + 1);
-        hasTopic = true;
-        if (!newTopic.empty() && newTopic[0] == ':')
-            newTopic = newTopic.substr(1);
-    }
+    // TOPIC <channel> [:nouveau topic] (un trailing vide efface le topic)
+    std::string channelName = msg.param(0).str();
+    bool hasTopic = msg.paramCount >= 2;
+    std::string newTopic = msg.param(1).str();
 
     // Vérifier que le channel existe
-    std::map<std::string, Channel*>::iterator it = _channels.find(channelName);
-    if (it == _channels.end())
+    Channel* channel = findChannel(channelName);
+    if (!channel)
     {
-        sendNumericReply(client, "403", channelName + " :No such channel");
+        sendNumericReply(client, "403", channelName, ":No such channel");
         return;
     }
 
-    Channel* channel = it->second;
-
     // Vérifier que le client est membre du channel
     if (!channel->isMember(&client))
     {
-        sendNumericReply(client, "442", channelName + " :You're not on that channel");
+        sendNumericReply(client, "442", channelName, ":You're not on that channel");
         return;
     }
 
@@ -211,9 +177,15 @@ void Server::handleTopic(Client& client, const std::string& params)
     {
         // Mode consultation : afficher le topic actuel
         if (channel->getTopic().empty())
-            sendNumericReply(client, "331", channelName + " :No topic is set");
-        else
-            sendNumericReply(client, "332", channelName + " :" + channel->getTopic());
+            sendNumericReply(client, "331", channelName, ":No topic is set");
+        else if (!client.isRemote())
+        {
+            MessageBuilder reply(_serverName.size() + client.getNickname().size() + channelName.size()
+                                 + channel->getTopic().size() + 16);
+            beginNumeric(reply, client, "332");
+            reply << channelName << " :" << channel->getTopic();
+            client.queueMessage(reply.finish());
+        }
     }
     else
     {
@@ -221,7 +193,7 @@ void Server::handleTopic(Client& client, const std::string& params)
         // Vérifier si le mode +t est actif (seuls les ops peuvent changer le topic)
         if (channel->isTopicRestricted() && !channel->isOperator(&client))
         {
-            sendNumericReply(client, "482", channelName + " :You're not channel operator");
+            sendNumericReply(client, "482", channelName, ":You're not channel operator");
             return;
         }
 
@@ -229,66 +201,54 @@ void Server::handleTopic(Client& client, const std::string& params)
         channel->setTopic(newTopic);
 
         // Notifier tous les membres du changement de topic
-        std::string topicMsg = getClientPrefix(client) + " TOPIC " + channelName + " :" + newTopic + "\r\n";
+        MessageBuilder topicBuilder(client.getPrefix().size() + channelName.size() + newTopic.size() + 16);
+        topicBuilder << client.getPrefix() << " TOPIC " << channelName << " :" << newTopic;
+        MessageRef topicMsg = topicBuilder.finish();
         channel->broadcastMessageAll(topicMsg);
+        propagate(topicMsg, client.getUplink());
 
-        std::cout << "[TOPIC] " << client.getNickname() << " set topic of " << channelName << " to: " << newTopic << std::endl;
+        LogLine(LOG_INFO) << "[TOPIC] " << client.getNickname() << " set topic of " << channelName << " to: " << newTopic;
     }
 }
 
 // Gère la commande MODE : changer les modes d'un channel
-void Server::handleMode(Client& client, const std::string& params) {
-    // Parser: MODE <channel> <modes> [<params>...]
-    
-    std::istringstream iss(params);
-    std::string target;
-    std::string modeString;
+void Server::handleMode(Client& client, const IrcMessage& msg) {
+    // MODE <channel> <modes> [<params>...]
     
     // Extraire le channel
-    if (!(iss >> target)) {
+    if (msg.param(0).empty()) {
         sendNumericReply(client, "461", "MODE :Not enough parameters");
         return;
     }
+    std::string target = msg.param(0).str();
     
     // Extraire la chaîne de modes
-    if (!(iss >> modeString)) {
+    if (msg.param(1).empty()) {
         // Pas de modes fournis → afficher les modes actuels
         if (target[0] == '#') {
-            std::map<std::string, Channel*>::iterator it = _channels.find(target);
-            if (it == _channels.end()) {
-                sendNumericReply(client, "403", target + " :No such channel");
+            Channel* channel = findChannel(target);
+            if (!channel) {
+                sendNumericReply(client, "403", target, ":No such channel");
                 return;
             }
-            
-            Channel* channel = it->second;
             if (!channel->isMember(&client)) {
-                sendNumericReply(client, "442", target + " :You're not on that channel");
+                sendNumericReply(client, "442", target, ":You're not on that channel");
                 return;
             }
             
             // Construire la chaîne des modes actifs
-            std::string activeModes = "+";
-            std::string modeParams = "";
+            std::string activeModes;
+            std::string modeParams;
+            channel->formatModes(activeModes, modeParams);
             
-            if (channel->isInviteOnly())
-                activeModes += "i";
-            if (channel->isTopicRestricted())
-                activeModes += "t";
-            if (!channel->getKey().empty()) {
-                activeModes += "k";
-                modeParams += " " + channel->getKey();
+            if (!client.isRemote())
+            {
+                MessageBuilder reply(_serverName.size() + client.getNickname().size() + target.size()
+                                     + activeModes.size() + modeParams.size() + 16);
+                beginNumeric(reply, client, "324");
+                reply << target << ' ' << activeModes << modeParams;
+                client.queueMessage(reply.finish());
             }
-            if (channel->getUserLimit() > 0) {
-                activeModes += "l";
-                std::ostringstream oss;
-                oss << channel->getUserLimit();
-                modeParams += " " + oss.str();
-            }
-            
-            if (activeModes == "+")
-                activeModes = "+";
-            
-            sendNumericReply(client, "324", target + " " + activeModes + modeParams);
             return;
         }
         sendNumericReply(client, "461", "MODE :Not enough parameters");
@@ -302,36 +262,30 @@ void Server::handleMode(Client& client, const std::string& params) {
     }
     
     // Vérifier que le channel existe
-    std::map<std::string, Channel*>::iterator it = _channels.find(target);
-    if (it == _channels.end()) {
-        sendNumericReply(client, "403", target + " :No such channel");
+    Channel* channel = findChannel(target);
+    if (!channel) {
+        sendNumericReply(client, "403", target, ":No such channel");
         return;
     }
     
-    Channel* channel = it->second;
-    
     // Vérifier que le client est dans le channel
     if (!channel->isMember(&client)) {
-        sendNumericReply(client, "442", target + " :You're not on that channel");
+        sendNumericReply(client, "442", target, ":You're not on that channel");
         return;
     }
     
     // Vérifier que le client est opérateur
     if (!channel->isOperator(&client)) {
-        sendNumericReply(client, "482", target + " :You're not channel operator");
+        sendNumericReply(client, "482", target, ":You're not channel operator");
         return;
     }
     
-    // Extraire les paramètres restants
-    std::vector<std::string> modeParams;
-    std::string param;
-    while (iss >> param) {
-        modeParams.push_back(param);
-    }
+    // Les paramètres des modes suivent la chaîne de modes
+    StringRef modeString = msg.param(1);
     
     // Parser et appliquer les modes
     bool adding = true;
-    size_t paramIndex = 0;
+    size_t paramIndex = 2;
     std::string broadcastModes = "";
     std::string broadcastParams = "";
     bool validModeFound = false;
@@ -369,11 +323,11 @@ void Server::handleMode(Client& client, const std::string& params) {
             case 'k': {
                 if (adding) {
                     // +k nécessite un paramètre
-                    if (paramIndex >= modeParams.size()) {
+                    if (paramIndex >= msg.paramCount) {
                         sendNumericReply(client, "461", "MODE +k :Not enough parameters");
                         continue;
                     }
-                    std::string key = modeParams[paramIndex++];
+                    std::string key = msg.param(paramIndex++).str();
                     channel->setKey(key);
                     broadcastModes += 'k';
                     broadcastParams += " " + key;
@@ -388,21 +342,21 @@ void Server::handleMode(Client& client, const std::string& params) {
             
             case 'o': {
                 // +o/-o nécessite un paramètre (nickname)
-                if (paramIndex >= modeParams.size()) {
+                if (paramIndex >= msg.paramCount) {
                     sendNumericReply(client, "461", "MODE +o :Not enough parameters");
                     continue;
                 }
                 
-                std::string targetNick = modeParams[paramIndex++];
+                std::string targetNick = msg.param(paramIndex++).str();
                 Client* targetClient = findClientByNickname(targetNick);
                 
                 if (!targetClient) {
-                    sendNumericReply(client, "401", targetNick + " :No such nick/channel");
+                    sendNumericReply(client, "401", targetNick, ":No such nick/channel");
                     continue;
                 }
                 
                 if (!channel->isMember(targetClient)) {
-                    sendNumericReply(client, "441", targetNick + " " + target + " :They aren't on that channel");
+                    sendNumericReply(client, "441", targetNick, target, ":They aren't on that channel");
                     continue;
                 }
                 
@@ -421,12 +375,12 @@ void Server::handleMode(Client& client, const std::string& params) {
             case 'l': {
                 if (adding) {
                     // +l nécessite un paramètre (limite)
-                    if (paramIndex >= modeParams.size()) {
+                    if (paramIndex >= msg.paramCount) {
                         sendNumericReply(client, "461", "MODE +l :Not enough parameters");
                         continue;
                     }
                     
-                    std::string limitStr = modeParams[paramIndex++];
+                    std::string limitStr = msg.param(paramIndex++).str();
                     int limit = std::atoi(limitStr.c_str());
                     
                     if (limit <= 0) {
@@ -447,15 +401,19 @@ void Server::handleMode(Client& client, const std::string& params) {
             }
             
             default:
-                sendNumericReply(client, "472", std::string(1, mode) + " :is unknown mode char to me");
+                sendNumericReply(client, "472", StringRef(&mode, 1), ":is unknown mode char to me");
                 continue;
         }
     }
     
     // Broadcast seulement si au moins un mode valide a été appliqué
     if (validModeFound && !broadcastModes.empty()) {
-        std::string modeMsg = getClientPrefix(client) + " MODE " + target + " " + broadcastModes + broadcastParams + "\r\n";
+        MessageBuilder modeBuilder(client.getPrefix().size() + target.size() + broadcastModes.size()
+                                   + broadcastParams.size() + 16);
+        modeBuilder << client.getPrefix() << " MODE " << target << ' ' << broadcastModes << broadcastParams;
+        MessageRef modeMsg = modeBuilder.finish();
         channel->broadcastMessageAll(modeMsg);
-        std::cout << "[MODE] " << client.getNickname() << " set mode " << broadcastModes << broadcastParams << " on " << target << std::endl;
+        propagate(modeMsg, client.getUplink());
+        LogLine(LOG_INFO) << "[MODE] " << client.getNickname() << " set mode " << broadcastModes << broadcastParams << " on " << target;
     }
 }
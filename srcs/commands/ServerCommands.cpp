@@ -0,0 +1,96 @@
+#include "Server.hpp"
+#include "Logger.hpp"
+#include <sstream>    // Pour std::ostringstream
+#include <cctype>     // Pour std::tolower()
+
+// Gère la commande OPER : devenir opérateur IRC (accès à STATS)
+void Server::handleOper(Client& client, const IrcMessage& msg)
+{
+    // OPER <name> <password> : un seul compte, --oper-name et --oper-password
+    if (_config.operPassword.empty())
+    {
+        sendNumericReply(client, "491", ":No O-lines for your host");
+        return;
+    }
+
+    // Nom ou mot de passe faux : même réponse, sans indiquer lequel
+    if (msg.param(0) != _config.operName.c_str() || msg.param(1) != _config.operPassword.c_str())
+    {
+        sendNumericReply(client, "464", ":Password incorrect");
+        return;
+    }
+
+    client.setIrcOperator(true);
+    sendNumericReply(client, "381", ":You are now an IRC operator");
+    MessageBuilder modeMsg(2 * client.getNickname().size() + 16);
+    modeMsg << ':' << client.getNickname() << " MODE " << client.getNickname() << " :+o";
+    client.queueMessage(modeMsg.finish());
+
+    LogLine(LOG_INFO) << "[OPER] " << client.getNickname() << " is now an IRC operator";
+}
+
+// Gère la commande STATS : compteurs du serveur (opérateurs IRC uniquement)
+void Server::handleStats(Client& client, const IrcMessage& msg)
+{
+    // STATS <query> : m (commandes), u (uptime), z (toutes les métriques)
+    if (!client.isIrcOperator())
+    {
+        sendNumericReply(client, "481", ":Permission Denied- You're not an IRC operator");
+        return;
+    }
+
+    char query = msg.param(0).empty() ? '*' : std::tolower(msg.param(0)[0]);
+
+    if (query == 'm')
+    {
+        // RPL_STATSCOMMANDS : <commande> <appels> <octets> <appels distants>
+        for (size_t i = 0; i < _commands.size(); ++i)
+        {
+            std::ostringstream line;
+            line << _commands[i].name << " " << _commands[i].calls << " " << _commands[i].bytes << " "
+                 << _commands[i].remoteCalls;
+            sendNumericReply(client, "212", line.str());
+        }
+    }
+    else if (query == 'u')
+    {
+        // RPL_STATSUPTIME
+        long uptime = time(NULL) - _startTime;
+        std::ostringstream line;
+        line << ":Server Up " << uptime / 86400 << " days " << (uptime / 3600) % 24 << ":"
+             << ((uptime / 60) % 60 < 10 ? "0" : "") << (uptime / 60) % 60 << ":"
+             << (uptime % 60 < 10 ? "0" : "") << uptime % 60;
+        sendNumericReply(client, "242", line.str());
+    }
+    else if (query == 'z')
+    {
+        // RPL_STATSDEBUG : une ligne par métrique (même format que l'export local)
+        std::istringstream metrics(formatMetrics());
+        std::string line;
+        while (std::getline(metrics, line))
+            sendNumericReply(client, "249", ":" + line);
+    }
+
+    // RPL_ENDOFSTATS
+    sendNumericReply(client, "219", StringRef(&query, 1), ":End of STATS report");
+}
+
+// Gère la commande PING : le client vérifie que le serveur répond
+void Server::handlePing(Client& client, const IrcMessage& msg)
+{
+    // PING <token>
+    if (msg.param(0).empty())
+    {
+        sendNumericReply(client, "409", ":No origin specified");
+        return;
+    }
+    sendToClient(client, ":" + _serverName + " PONG " + _serverName + " :" + msg.param(0).str());
+}
+
+// Gère la commande PONG : réponse au PING du serveur
+void Server::handlePong(Client& client, const IrcMessage& msg)
+{
+    // La réception de la ligne a déjà annulé le PING en attente (markActivity)
+    (void)client;
+    (void)msg;
+}
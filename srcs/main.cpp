@@ -1,7 +1,9 @@
 #include "Server.hpp"
+#include "Config.hpp"
+#include "Logger.hpp"
 #include <iostream>    // Pour std::cout, std::cerr
-#include <cstdlib>     // Pour std::atoi(), exit()
-#include <csignal>     // Pour signal(), SIGINT, SIGTERM, SIGQUIT
+#include <cstdlib>     // Pour std::atoi()
+#include <csignal>     // Pour signal(), SIGINT, SIGTERM, SIGQUIT, SIGPIPE
 
 // Pointeur global pour gérer Ctrl+C proprement
 Server* g_server = NULL;
@@ -9,18 +11,16 @@ Server* g_server = NULL;
 void signal_handler(int signum)
 {
     (void)signum;
-    std::cout << "\n\nReceived interrupt signal" << std::endl;
+    // Pas d'arrêt direct ici : les boucles se terminent, puis le destructeur nettoie
     if (g_server)
-        g_server->stop();
-    exit(0);
+        g_server->requestStop();
 }
 
 int main(int argc, char** argv)
 {
-    if (argc != 3)
+    if (argc < 3)
     {
-        std::cerr << "Usage: " << argv[0] << " <port> <password>" << std::endl;
-        std::cerr << "Example: " << argv[0] << " 6667 mypassword" << std::endl;
+        printServerOptions(argv[0]);
         return (1);
     }
     
@@ -37,23 +37,47 @@ int main(int argc, char** argv)
         std::cerr << "Error: Password cannot be empty" << std::endl;
         return (1);
     }
+
+    ServerConfig config;
+    std::string error;
+    if (!parseServerOptions(argc, argv, 3, config, error))
+    {
+        std::cerr << "Error: " << error << std::endl;
+        printServerOptions(argv[0]);
+        return (1);
+    }
     
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     signal(SIGQUIT, signal_handler);
+    signal(SIGPIPE, SIG_IGN);  // Un send() vers un client parti retourne EPIPE au lieu de tuer le serveur
     
+    // Journal asynchrone : la boucle d'événements n'écrit jamais elle-même sur stdout
+    Logger::setLevel(config.logLevel);
+    CaseMap::set(config.caseMapping);
+    if (!Logger::start())
+    {
+        std::cerr << "Error: Failed to start logger thread" << std::endl;
+        return (1);
+    }
+
     try
     {
-        Server server(port, password);
+        Server server(port, password, config);
         g_server = &server;
         
         server.run();
     }
     catch (const std::exception& e)
     {
-        std::cerr << "Exception: " << e.what() << std::endl;
+        LogLine(LOG_ERROR) << "Exception: " << e.what();
+        Logger::stop();
         return (1);
     }
+    g_server = NULL;
+
+    // Écrit les dernières lignes avant de quitter
+    Logger::stop();
     
     return (0);
 }
\ No newline at end of file
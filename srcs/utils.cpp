@@ -2,6 +2,7 @@
 #include <fcntl.h>
 #include <iostream>
 #include <cstdlib>
+#include <ctime>     // Pour clock_gettime()
 
 // Met un file descriptor en mode non-bloquant
 // Permet à recv() et send() de retourner immédiatement au lieu d'attendre
@@ -30,4 +31,12 @@ void error_exit(const std::string& message)
 {
     std::cerr << "Error: " << message << std::endl;
     exit(1);
-}
\ No newline at end of file
+}
+
+// Retourne le temps écoulé depuis un point fixe, en millisecondes
+unsigned long monotonic_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}